@@ -5,25 +5,15 @@ namespace kagami {
     return string("<Object Type=") + obj.GetTypeId() + string(">");
   }
 
-  Message SystemCommand(ObjectMap &p) {
-    auto tc_result = TypeChecking(
-      { Expect("command", kTypeIdString) }, p);
-
-    if (TC_FAIL(tc_result)) { return TC_ERROR(tc_result); }
-
-    int64_t result = system(p.Cast<string>("command").data());
+  Message SystemCommand(ObjectView &p) {
+    int64_t result = system(p.Cast<string>(0).data());
     return Message().SetObject(Object(result, kTypeIdInt));
   }
 
-  Message ThreadSleep(ObjectMap& p) {
-    auto tc_result = TypeChecking(
-      { Expect("milliseconds", kTypeIdInt) }, p);
-
-    if (TC_FAIL(tc_result)) { return TC_ERROR(tc_result); }
-
-    auto value = p.Cast<int64_t>("milliseconds");
+  Message ThreadSleep(ObjectView &p) {
+    auto value = p.Cast<int64_t>(0);
 #ifdef _MSC_VER
-    Sleep(DWORD(p.Cast<int64_t>("milliseconds")));
+    Sleep(DWORD(p.Cast<int64_t>(0)));
 #else
     timespec spec;
     
@@ -72,7 +62,7 @@ namespace kagami {
 
     vector<string> methods = management::type::GetMethods(obj.GetTypeId());
 
-    if (!management::type::CheckMethod(kStrPrint, obj.GetTypeId())) {
+    if (!management::type::CheckMethod(kStrPrint, obj.GetTypeRecord())) {
       puts(MakeObjectString(obj).data());
       return Message();
     }
@@ -105,64 +95,41 @@ namespace kagami {
     return Message().SetObject(buf);
   }
 
-  Message GetChar(ObjectMap &p) {
+  Message GetChar(ObjectView &p) {
     auto value = static_cast<char>(fgetc(VM_STDIN));
     return Message().SetObject(string().append(1, value));
   }
 
-  Message ExistFSObject(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("path", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto &path = p.Cast<string>("path");
+  Message ExistFSObject(ObjectView &p) {
+    auto &path = p.Cast<string>(0);
     auto exists = fs::exists(fs::path(path));
 
     return Message().SetObject(exists);
   }
 
-  Message CreateNewDirectory(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("path", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto &path = p.Cast<string>("path");
+  Message CreateNewDirectory(ObjectView &p) {
+    auto &path = p.Cast<string>(0);
     auto result = fs::create_directories(path);
     return Message().SetObject(result);
   }
 
-  Message RemoveFSObject(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("path", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto &path = p.Cast<string>("path");
+  Message RemoveFSObject(ObjectView &p) {
+    auto &path = p.Cast<string>(0);
     auto result = fs::remove(fs::path(path));
 
     return Message().SetObject(result);
   }
 
-  Message RemoveFSObject_Recursive(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("path", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto &path = p.Cast<string>("path");
+  Message RemoveFSObject_Recursive(ObjectView &p) {
+    auto &path = p.Cast<string>(0);
     auto result = fs::remove_all(fs::path(path));
     
     return Message().SetObject(int64_t(result));
   }
 
-  Message CopyFSObject(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { 
-        Expect("from", kTypeIdString), 
-        Expect("to", kTypeIdString)
-      }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto from = p.Cast<string>("from");
-    auto to = p.Cast<string>("to");
+  Message CopyFSObject(ObjectView &p) {
+    auto from = p.Cast<string>(0);
+    auto to = p.Cast<string>(1);
     Message result;
 
     try {
@@ -175,62 +142,43 @@ namespace kagami {
     return result;
   }
 
-  Message CopyFSFile(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("from", kTypeIdString),
-        Expect("to", kTypeIdString)
-      }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto from = p.Cast<string>("from");
-    auto to = p.Cast<string>("to");
+  Message CopyFSFile(ObjectView &p) {
+    auto from = p.Cast<string>(0);
+    auto to = p.Cast<string>(1);
     auto result = fs::copy_file(fs::path(from), fs::path(to));
     return Message().SetObject(result);
   }
 
-  Message SetWorkingDir(ObjectMap &p) {
-    auto tc_result = TypeChecking(
-      { Expect("dir", kTypeIdString) }, p);
-
-    if (TC_FAIL(tc_result)) return TC_ERROR(tc_result);
-
-    auto &dir = p.Cast<string>("dir");
+  Message SetWorkingDir(ObjectView &p) {
+    auto &dir = p.Cast<string>(0);
     bool result = management::runtime::SetWorkingDirectory(dir);
     return Message().SetObject(result);
   }
 
-  Message GetWorkingDir(ObjectMap &p) {
+  Message GetWorkingDir(ObjectView &p) {
     return Message().SetObject(management::runtime::GetWorkingDirectory());
   }
 
-  Message GetScriptAbsolutePath(ObjectMap &p) {
+  Message GetScriptAbsolutePath(ObjectView &p) {
     return Message().SetObject(mgmt::runtime::GetScriptAbsolutePath());
   }
 
-  Message GetPlatform(ObjectMap &p) {
+  Message GetPlatform(ObjectView &p) {
     return Message().SetObject(kPlatformType);
   }
 
-  Message GetFunctionPointer(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { 
-        Expect("library", kTypeIdString),
-        Expect("id", kTypeIdString)
-      }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
+  Message GetFunctionPointer(ObjectView &p) {
 #ifdef _WIN32
-    wstring path = s2ws(p.Cast<string>("library"));
-    string id = p.Cast<string>("id");
+    wstring path = s2ws(p.Cast<string>(0));
+    string id = p.Cast<string>(1);
     HMODULE mod = LoadLibraryW(path.data());
 
     if (mod == nullptr) return Message().SetObject(int64_t(0));
 
     auto func = GenericFunctionPointer(GetProcAddress(mod, id.data()));
 #else
-    string path = p.Cast<string>("library");
-    string id = p.Cast<string>("id");
+    string path = p.Cast<string>(0);
+    string id = p.Cast<string>(1);
     void *mod = dlopen(path.data(), RTLD_LAZY);
 
     if (mod == nullptr) return Message().SetObject(int64_t(0));
@@ -240,11 +188,8 @@ namespace kagami {
     return Message().SetObject(Object(func, kTypeIdFunctionPointer));
   }
 
-  Message GetDirectoryContent(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("path", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    string path_str = p.Cast<string>("path");
+  Message GetDirectoryContent(ObjectView &p) {
+    string path_str = p.Cast<string>(0);
     auto managed_array = make_shared<ObjectArray>();
     for (auto &unit : fs::directory_iterator(path_str)) {
       managed_array->emplace_back(Object(unit.path().string(), kTypeIdString));
@@ -253,11 +198,8 @@ namespace kagami {
     return Message().SetObject(Object(managed_array, kTypeIdArray));
   }
 
-  Message GetFilenameExtension(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("path", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    fs::path path_cls(p.Cast<string>("path"));
+  Message GetFilenameExtension(ObjectView &p) {
+    fs::path path_cls(p.Cast<string>(0));
     return Message().SetObject(Object(path_cls.extension().string(), kTypeIdString));
   }
 
@@ -268,20 +210,32 @@ namespace kagami {
     CreateImpl(FunctionImpl(GetChar, "", "getchar"));
     CreateImpl(FunctionImpl(Print, kStrMe, "print"));
     CreateImpl(FunctionImpl(PrintLine, kStrMe, "println"));
-    CreateImpl(FunctionImpl(SystemCommand, "command", "console"));
-    CreateImpl(FunctionImpl(ThreadSleep, "milliseconds", "sleep"));
-    CreateImpl(FunctionImpl(SetWorkingDir, "dir", "setwd"));
+    CreateImpl(FunctionImpl(SystemCommand, "command", "console")
+      .SetSignature({ Expect("command", kTypeIdString) }));
+    CreateImpl(FunctionImpl(ThreadSleep, "milliseconds", "sleep")
+      .SetSignature({ Expect("milliseconds", kTypeIdInt) }));
+    CreateImpl(FunctionImpl(SetWorkingDir, "dir", "setwd")
+      .SetSignature({ Expect("dir", kTypeIdString) }));
     CreateImpl(FunctionImpl(GetWorkingDir, "", "getwd"));
     CreateImpl(FunctionImpl(GetScriptAbsolutePath, "", "get_script_path"));
     CreateImpl(FunctionImpl(GetPlatform, "", "get_platform"));
-    CreateImpl(FunctionImpl(GetFunctionPointer, "library|id", "get_function_ptr"));
-    CreateImpl(FunctionImpl(ExistFSObject, "path", "exist_fsobj"));
-    CreateImpl(FunctionImpl(CreateNewDirectory, "path", "create_dir"));
-    CreateImpl(FunctionImpl(RemoveFSObject, "path", "remove_fsobj"));
-    CreateImpl(FunctionImpl(RemoveFSObject_Recursive, "path", "remove_all_fsobj"));
-    CreateImpl(FunctionImpl(CopyFSObject, "from|to", "copy_fsobj"));
-    CreateImpl(FunctionImpl(CopyFSFile, "from|to", "copy_file"));
-    CreateImpl(FunctionImpl(GetDirectoryContent, "path", "dir_content"));
-    CreateImpl(FunctionImpl(GetFilenameExtension, "path", "filename_ext"));
+    CreateImpl(FunctionImpl(GetFunctionPointer, "library|id", "get_function_ptr")
+      .SetSignature({ Expect("library", kTypeIdString), Expect("id", kTypeIdString) }));
+    CreateImpl(FunctionImpl(ExistFSObject, "path", "exist_fsobj")
+      .SetSignature({ Expect("path", kTypeIdString) }));
+    CreateImpl(FunctionImpl(CreateNewDirectory, "path", "create_dir")
+      .SetSignature({ Expect("path", kTypeIdString) }));
+    CreateImpl(FunctionImpl(RemoveFSObject, "path", "remove_fsobj")
+      .SetSignature({ Expect("path", kTypeIdString) }));
+    CreateImpl(FunctionImpl(RemoveFSObject_Recursive, "path", "remove_all_fsobj")
+      .SetSignature({ Expect("path", kTypeIdString) }));
+    CreateImpl(FunctionImpl(CopyFSObject, "from|to", "copy_fsobj")
+      .SetSignature({ Expect("from", kTypeIdString), Expect("to", kTypeIdString) }));
+    CreateImpl(FunctionImpl(CopyFSFile, "from|to", "copy_file")
+      .SetSignature({ Expect("from", kTypeIdString), Expect("to", kTypeIdString) }));
+    CreateImpl(FunctionImpl(GetDirectoryContent, "path", "dir_content")
+      .SetSignature({ Expect("path", kTypeIdString) }));
+    CreateImpl(FunctionImpl(GetFilenameExtension, "path", "filename_ext")
+      .SetSignature({ Expect("path", kTypeIdString) }));
   }
 }
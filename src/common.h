@@ -32,6 +32,7 @@
 #include <tuple>
 #include <unordered_set>
 #include <optional>
+#include <chrono>
 
 #include "toml11/toml.hpp"
 
@@ -124,6 +125,7 @@ namespace kagami {
   const string kTypeIdIterator        = "iterator";
   const string kTypeIdPair            = "pair";
   const string kTypeIdTable           = "table";
+  const string kTypeIdRange           = "range";
   const string kTypeIdStruct          = "struct";
   const string kTypeIdWindowEvent     = "window_event";
   const string kTypeIdWindow          = "window";
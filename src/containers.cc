@@ -1,32 +1,26 @@
 #include "containers.h"
 
 namespace kagami {
-  Message IteratorStepForward(ObjectMap &p) {
-    auto &it = p[kStrMe].Cast<UnifiedIterator>();
+  Message IteratorStepForward(ObjectView &p) {
+    auto &it = p.Me().Cast<UnifiedIterator>();
     it.StepForward();
     return Message();
   }
 
-  Message IteratorStepBack(ObjectMap &p) {
-    auto &it = p[kStrMe].Cast<UnifiedIterator>();
+  Message IteratorStepBack(ObjectView &p) {
+    auto &it = p.Me().Cast<UnifiedIterator>();
     it.StepBack();
     return Message();
   }
 
-  Message IteratorOperatorCompare(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect(kStrRightHandSide, kTypeIdIterator) }, p
-    );
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto &rhs = p[kStrRightHandSide].Cast<UnifiedIterator>();
-    auto &lhs = p[kStrMe].Cast<UnifiedIterator>();
+  Message IteratorOperatorCompare(ObjectView &p) {
+    auto &rhs = p[0].Cast<UnifiedIterator>();
+    auto &lhs = p.Me().Cast<UnifiedIterator>();
     return Message().SetObject(lhs.Compare(rhs));
   }
 
-  Message IteratorGet(ObjectMap &p) {
-    auto &it = p[kStrMe].Cast<UnifiedIterator>();
+  Message IteratorGet(ObjectView &p) {
+    auto &it = p.Me().Cast<UnifiedIterator>();
     return Message().SetObject(it.Unpack());
   }
 
@@ -36,21 +30,14 @@ namespace kagami {
     return lhs_value.Compare(rhs_value);
   }
 
-  Message NewArray(ObjectMap &p) {
-    auto tc_result = TypeChecking(
-      { Expect("size", kTypeIdInt) }, p,
-      { "size" }
-    );
-
-    if (TC_FAIL(tc_result)) return TC_ERROR(tc_result);
-
+  Message NewArray(ObjectView &p) {
     ManagedArray base = make_shared<ObjectArray>();
 
-    if (!p["size"].Null()) {
-      size_t size = p.Cast<int64_t>("size");
+    if (!p[0].Null()) {
+      size_t size = p.Cast<int64_t>(0);
       if (size < 0) return Message("Invalid array size.", kStateError);
 
-      Object obj = p["init_value"];
+      Object obj = p[1];
 
       auto type_id = obj.GetTypeId();
 
@@ -62,15 +49,10 @@ namespace kagami {
     return Message().SetObject(Object(base, kTypeIdArray));
   }
 
-  Message ArrayGetElement(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("index", kTypeIdInt) }, p
-    );
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    ObjectArray &base = p.Cast<ObjectArray>(kStrMe);
-    size_t idx = p.Cast<int64_t>("index");
+  Message ArrayGetElement(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    ObjectArray &base = p.Me().Cast<ObjectArray>();
+    size_t idx = p.Cast<int64_t>(0);
     size_t size = base.size();
 
     if (idx >= size) return Message("Subscript is out of range", kStateError);
@@ -78,47 +60,52 @@ namespace kagami {
     return Message().SetObject(Object().PackObject(base[idx]));
   }
 
-  Message ArrayGetSize(ObjectMap &p) {
-    auto &obj = p[kStrMe];
+  Message ArrayGetSize(ObjectView &p) {
+    auto &obj = p.Me();
     int64_t size = static_cast<int64_t>(obj.Cast<ObjectArray>().size());
-    return Message().SetObject(Object(make_shared<int64_t>(size), kTypeIdInt));
+    return Message().SetObject(Object(size, kTypeIdInt));
   }
 
-  Message ArrayEmpty(ObjectMap &p) {
-    return Message().SetObject(p[kStrMe].Cast<ObjectArray>().empty());
+  Message ArrayEmpty(ObjectView &p) {
+    return Message().SetObject(p.Me().Cast<ObjectArray>().empty());
   }
 
-  Message ArrayPush(ObjectMap &p) {
-    ObjectArray &base = p.Cast<ObjectArray>(kStrMe);
-    Object obj = management::type::CreateObjectCopy(p["object"]);
+  Message ArrayPush(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    ObjectArray &base = p.Me().Cast<ObjectArray>();
+    Object obj = management::type::CreateObjectCopy(p[0]);
     base.emplace_back(obj);
 
     return Message();
   }
 
-  Message ArrayPop(ObjectMap &p) {
-    ObjectArray &base = p.Cast<ObjectArray>(kStrMe);
+  Message ArrayPop(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    ObjectArray &base = p.Me().Cast<ObjectArray>();
     if (!base.empty()) base.pop_back();
 
     return Message().SetObject(base.empty());
   }
 
-  Message ArrayHead(ObjectMap &p) {
-    auto &base = p[kStrMe].Cast<ObjectArray>();
+  Message ArrayHead(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &base = p.Me().Cast<ObjectArray>();
     shared_ptr<UnifiedIterator> it = 
       make_shared<UnifiedIterator>(base.begin(), kContainerObjectArray);
     return Message().SetObject(Object(it, kTypeIdIterator));
   }
 
-  Message ArrayTail(ObjectMap &p) {
-    auto &base = p[kStrMe].Cast<ObjectArray>();
+  Message ArrayTail(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &base = p.Me().Cast<ObjectArray>();
     shared_ptr<UnifiedIterator> it = 
       make_shared<UnifiedIterator>(base.end(), kContainerObjectArray);
     return Message().SetObject(Object(it, kTypeIdIterator));
   }
 
-  Message ArrayClear(ObjectMap &p) {
-    auto &base = p.Cast<ObjectArray>(kStrMe);
+  Message ArrayClear(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &base = p.Me().Cast<ObjectArray>();
     base.clear();
     base.shrink_to_fit();
     return Message();
@@ -150,22 +137,24 @@ namespace kagami {
     return dest_base;
   }
 
-  Message NewPair(ObjectMap &p) {
-    auto &left = p["left"];
-    auto &right = p["right"];
+  Message NewPair(ObjectView &p) {
+    auto &left = p[0];
+    auto &right = p[1];
     ManagedPair pair = make_shared<ObjectPair>(
       management::type::CreateObjectCopy(left),
       management::type::CreateObjectCopy(right));
     return Message().SetObject(Object(pair, kTypeIdPair));
   }
 
-  Message PairLeft(ObjectMap &p) {
-    auto &base = p.Cast<ObjectPair>(kStrMe);
+  Message PairLeft(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &base = p.Me().Cast<ObjectPair>();
     return Message().SetObject(Object().PackObject(base.first));
   }
 
-  Message PairRight(ObjectMap &p) {
-    auto &base = p.Cast<ObjectPair>(kStrMe);
+  Message PairRight(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &base = p.Me().Cast<ObjectPair>();
     return Message().SetObject(Object().PackObject(base.second));
   }
 
@@ -178,66 +167,109 @@ namespace kagami {
     return dest_base;
   }
 
-  Message NewTable(ObjectMap &p) {
+  Message NewTable(ObjectView &p) {
     ManagedTable table = make_shared<ObjectTable>();
     return Message().SetObject(Object(table, kTypeIdTable));
   }
 
-  Message TableInsert(ObjectMap &p) {
+  Message TableInsert(ObjectView &p) {
     using namespace management::type;
-    auto &table = p.Cast<ObjectTable>(kStrMe);
-    auto &key = p["key"];
-    auto &value = p["value"];
+    DetachSharedContent(p.Me());
+    auto &table = p.Me().Cast<ObjectTable>();
+    auto &key = p[0];
+    auto &value = p[1];
     auto result = table.insert(
       make_pair(CreateObjectCopy(key), CreateObjectCopy(value))
     );
     return Message();
   }
 
-  Message TableGetElement(ObjectMap &p) {
-    auto &table = p.Cast<ObjectTable>(kStrMe);
-    auto &dest_key = p["key"];
+  Message TableGetElement(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &table = p.Me().Cast<ObjectTable>();
+    auto &dest_key = p[0];
     auto &result = table[dest_key];
     return Message().SetObject(Object().PackObject(result));
   }
 
-  Message TableEraseElement(ObjectMap &p) {
-    auto &table = p.Cast<ObjectTable>(kStrMe);
-    auto &key = p["key"];
+  Message TableEraseElement(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &table = p.Me().Cast<ObjectTable>();
+    auto &key = p[0];
     auto count = table.erase(key);
     return Message().SetObject(static_cast<int64_t>(count));
   }
 
-  Message TableEmpty(ObjectMap &p) {
-    auto &table = p.Cast<ObjectTable>(kStrMe);
+  Message TableEmpty(ObjectView &p) {
+    auto &table = p.Me().Cast<ObjectTable>();
     return Message().SetObject(table.empty());
   }
 
-  Message TableSize(ObjectMap &p) {
-    auto &table = p.Cast<ObjectTable>(kStrMe);
+  Message TableSize(ObjectView &p) {
+    auto &table = p.Me().Cast<ObjectTable>();
     return Message().SetObject(static_cast<int64_t>(table.size()));
   }
 
-  Message TableClear(ObjectMap &p) {
-    auto &table = p.Cast<ObjectTable>(kStrMe);
+  Message TableClear(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &table = p.Me().Cast<ObjectTable>();
     table.clear();
     return Message();
   }
 
-  Message TableHead(ObjectMap &p) {
-    auto &table = p.Cast<ObjectTable>(kStrMe);
+  Message TableHead(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &table = p.Me().Cast<ObjectTable>();
     shared_ptr<UnifiedIterator> it =
       make_shared<UnifiedIterator>(table.begin(), kContainerObjectTable);
     return Message().SetObject(Object(it, kTypeIdIterator));
   }
 
-  Message TableTail(ObjectMap &p) {
-    auto &table = p.Cast<ObjectTable>(kStrMe);
+  Message TableTail(ObjectView &p) {
+    management::type::DetachSharedContent(p.Me());
+    auto &table = p.Me().Cast<ObjectTable>();
     shared_ptr<UnifiedIterator> it =
       make_shared<UnifiedIterator>(table.end(), kContainerObjectTable);
     return Message().SetObject(Object(it, kTypeIdIterator));
   }
 
+  //range(stop) counts from 0, range(start, stop[, step]) as usual.
+  Message NewRange(ObjectView &p) {
+    IntegerRange range{ 0, p.Cast<int64_t>(0), 1 };
+
+    if (!p[1].Null()) {
+      range.start = range.stop;
+      range.stop = p.Cast<int64_t>(1);
+    }
+
+    if (!p[2].Null()) range.step = p.Cast<int64_t>(2);
+
+    if (range.step == 0) return Message("Step of range can't be zero", kStateError);
+
+    return Message().SetObject(Object(make_shared<IntegerRange>(range), kTypeIdRange));
+  }
+
+  Message RangeGetElement(ObjectView &p) {
+    auto &range = p.Me().Cast<IntegerRange>();
+    auto idx = p.Cast<int64_t>(0);
+
+    if (idx < 0 || idx >= range.Size()) {
+      return Message("Subscript is out of range", kStateError);
+    }
+
+    return Message().SetObject(Object(range.At(idx), kTypeIdInt));
+  }
+
+  Message RangeGetSize(ObjectView &p) {
+    auto &range = p.Me().Cast<IntegerRange>();
+    return Message().SetObject(Object(range.Size(), kTypeIdInt));
+  }
+
+  Message RangeEmpty(ObjectView &p) {
+    auto &range = p.Me().Cast<IntegerRange>();
+    return Message().SetObject(range.Size() == 0);
+  }
+
   shared_ptr<void> TableDelivery(shared_ptr<void> ptr) {
     using namespace management::type;
     auto &table = *static_pointer_cast<ObjectTable>(ptr);
@@ -257,12 +289,15 @@ namespace kagami {
     using management::type::ObjectTraitsSetup;
 
     ObjectTraitsSetup(kTypeIdArray, ArrayDelivery, ArrayHasher)
+      .InitCopyOnWrite()
       .InitConstructor(
         FunctionImpl(NewArray, "size|init_value", "array", kParamAutoFill).SetLimit(0)
+          .SetSignature({ Expect("size", kTypeIdInt) }, { "size" })
       )
       .InitMethods(
         {
-          FunctionImpl(ArrayGetElement, "index", "__at"),
+          FunctionImpl(ArrayGetElement, "index", "__at")
+            .SetSignature({ Expect("index", kTypeIdInt) }),
           FunctionImpl(ArrayGetSize, "", "size"),
           FunctionImpl(ArrayPush, "object", "push"),
           FunctionImpl(ArrayPop, "object", "pop"),
@@ -281,10 +316,12 @@ namespace kagami {
           FunctionImpl(IteratorStepForward, "", "step_forward"),
           FunctionImpl(IteratorStepBack, "", "step_back"),
           FunctionImpl(IteratorOperatorCompare, kStrRightHandSide, kStrCompare)
+            .SetSignature({ Expect(kStrRightHandSide, kTypeIdIterator) })
         }
     );
 
     ObjectTraitsSetup(kTypeIdPair, PairDelivery)
+      .InitCopyOnWrite()
       .InitConstructor(
         FunctionImpl(NewPair, "left|right", "pair")
       )
@@ -296,6 +333,7 @@ namespace kagami {
     );
 
     ObjectTraitsSetup(kTypeIdTable, TableDelivery)
+      .InitCopyOnWrite()
       .InitConstructor(
         FunctionImpl(NewTable, "", "table")
       )
@@ -312,9 +350,30 @@ namespace kagami {
         }
     );
 
+    ObjectTraitsSetup(kTypeIdRange, PlainDeliveryImpl<IntegerRange>)
+      .InitConstructor(
+        FunctionImpl(NewRange, "start|stop|step", "range", kParamAutoFill).SetLimit(1)
+          .SetSignature(
+            {
+              Expect("start", kTypeIdInt),
+              Expect("stop", kTypeIdInt),
+              Expect("step", kTypeIdInt)
+            }, { "stop", "step" }
+          )
+      )
+      .InitMethods(
+        {
+          FunctionImpl(RangeGetElement, "index", "__at")
+            .SetSignature({ Expect("index", kTypeIdInt) }),
+          FunctionImpl(RangeGetSize, "", "size"),
+          FunctionImpl(RangeEmpty, "", "empty")
+        }
+    );
+
     EXPORT_CONSTANT(kTypeIdArray);
     EXPORT_CONSTANT(kTypeIdIterator);
     EXPORT_CONSTANT(kTypeIdPair);
     EXPORT_CONSTANT(kTypeIdTable);
+    EXPORT_CONSTANT(kTypeIdRange);
   }
 }
\ No newline at end of file
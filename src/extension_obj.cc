@@ -3,8 +3,6 @@
 namespace kagami {
   Message NewExtension(ObjectMap &p) { 
     using namespace ext;
-    auto tc = TypeChecking({ Expect("path",kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
     auto &path = p.Cast<string>("path");
     ManagedExtension extension = make_shared<Extension>(path);
     auto loader = extension->GetExtensionLoader();
@@ -39,8 +37,6 @@ namespace kagami {
 
   Message ExtensionFetchFunction(ObjectMap &p) {
     //TODO:Variable arugment
-    auto tc = TypeChecking({ Expect("id",kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
     auto &extension = p.Cast<Extension>(kStrMe);
     auto &id = p.Cast<string>("id");
     auto activity = extension.FetchFunction(id);
@@ -72,11 +68,13 @@ namespace kagami {
     ObjectTraitsSetup(kTypeIdExtension, ShallowDelivery)
       .InitConstructor(
         FunctionImpl(NewExtension, "path", kTypeIdExtension)
+          .SetSignature({ Expect("path", kTypeIdString) })
       )
       .InitMethods(
         {
           FunctionImpl(ExtensionGood, "", "good"),
           FunctionImpl(ExtensionFetchFunction, "id", "fetch")
+            .SetSignature({ Expect("id", kTypeIdString) })
         }
     );
 
@@ -327,6 +327,19 @@ namespace kagami {
     }
 
     action_base_.emplace_back(Command(frame_->symbol.back(), arguments));
+
+    //Patch the jump of short-circuit check to the logic operator
+    if (compare(frame_->symbol.back().GetKeywordValue(), kKeywordAnd, kKeywordOr)
+      && !frame_->short_circuit.empty()) {
+      size_t check_idx = frame_->short_circuit.top();
+      frame_->short_circuit.pop();
+
+      if (check_idx != kInvalidSlot) {
+        action_base_[check_idx].first.option.skip_distance = 
+          action_base_.size() - 1 - check_idx;
+      }
+    }
+
     frame_->symbol.pop_back();
     frame_->args.emplace_back(Argument("", kArgumentReturnStack, kStringTypeNull));
     if (frame_->symbol.empty() && (frame_->next.first == "," 
@@ -440,6 +453,28 @@ namespace kagami {
       }
     }
 
+    //Left operand of logic operator is checked before evaluating right one.
+    //Operand which can't be fetched twice is left to plain operator.
+    if (compare(token, kKeywordAnd, kKeywordOr)) {
+      size_t check_idx = kInvalidSlot;
+
+      if (!frame_->args.empty() && !frame_->args.back().IsPlaceholder()) {
+        auto &lhs = frame_->args.back();
+        bool fetchable = lhs.GetType() != kArgumentObjectStack ||
+          (lhs.option.domain.empty() && !lhs.option.use_last_assert);
+
+        if (fetchable) {
+          Command command;
+          command.first = Request(kKeywordShortCircuit);
+          command.second.push_back(lhs);
+          action_base_.push_back(command);
+          check_idx = action_base_.size() - 1;
+        }
+      }
+
+      frame_->short_circuit.push(check_idx);
+    }
+
     frame_->symbol.emplace_back(request);
   }
 
@@ -921,6 +956,45 @@ namespace kagami {
     return true;
   }
 
+  //Closure record only captures identifiers that appear in function body.
+  //Parameters are excluded since they're always provided by caller.
+  void VMCodeFactory::CollectFreeVariables(size_t fn_idx, size_t end_idx) {
+    auto &params = (*dest_)[fn_idx].second;
+    unordered_set<string> visited;
+    vector<string> result;
+
+    for (size_t idx = 1; idx < params.size(); ++idx) {
+      visited.insert(params[idx].GetData());
+    }
+
+    auto collect = [&](const string &id) -> void {
+      if (visited.insert(id).second) result.push_back(id);
+    };
+
+    for (size_t idx = fn_idx + 1; idx < end_idx; ++idx) {
+      auto &command = (*dest_)[idx];
+
+      if (command.first.type == kRequestFunction) {
+        collect(command.first.GetInterfaceId());
+        auto domain = command.first.GetInterfaceDomain();
+        if (domain.GetType() == kArgumentObjectStack) collect(domain.GetData());
+      }
+
+      for (auto &arg : command.second) {
+        if (arg.GetStringType() == kStringTypeIdentifier &&
+          compare(arg.GetType(), kArgumentNormal, kArgumentObjectStack)) {
+          collect(arg.GetData());
+        }
+
+        if (!arg.option.domain.empty() && arg.option.domain_type == kArgumentObjectStack) {
+          collect(arg.option.domain);
+        }
+      }
+    }
+
+    dest_->SetFreeVariables(fn_idx, std::move(result));
+  }
+
   bool VMCodeFactory::Start() {
     bool good = true;
     LexicalFactory lexer(tokens_, logger_);
@@ -983,10 +1057,11 @@ namespace kagami {
         if (ast_root == kKeywordIf || ast_root == kKeywordCase) {
           jump_stack_.push(JumpListFrame{ ast_root,
             dest_->size() + anchorage.size() - 1 });
+          if (ast_root == kKeywordCase) case_nest_ += 1;
         }
 
         if (ast_root == kKeywordWhile || ast_root == kKeywordFor) {
-          cycle_escaper_.push(nest_.size() + 1);
+          cycle_escaper_.push(CycleFrame{ nest_.size() + 1, case_nest_ });
         }
 
         if (ast_root == kKeywordStruct) {
@@ -1013,26 +1088,32 @@ namespace kagami {
           break;
         }
 
-        if (jump_stack_.top().nest_code == kKeywordIf) {
-          if (ast_root == kKeywordElif || ast_root == kKeywordElse) {
-            jump_stack_.top().jump_record.push_back(dest_->size());
-          }
-          else {
+        auto &jump_frame = jump_stack_.top();
+
+        if (jump_frame.nest_code == kKeywordIf) {
+          if (!compare(ast_root, kKeywordElif, kKeywordElse)) {
             AppendMessage("Invalid branch keyword at line " + to_string(it->first),
               logger_);
             break;
           }
         }
-        else if (jump_stack_.top().nest_code == kKeywordCase) {
-          if (ast_root == kKeywordWhen || ast_root == kKeywordElse) {
-            jump_stack_.top().jump_record.push_back(dest_->size());
-          }
-          else {
+        else if (jump_frame.nest_code == kKeywordCase) {
+          if (!compare(ast_root, kKeywordWhen, kKeywordElse)) {
             AppendMessage("Invalid branch keyword at line " + to_string(it->first), kStateError,
               logger_);
             break;
           }
         }
+
+        //Previous branch body leaves the block here
+        Command exit_jump;
+        exit_jump.first = Request(kKeywordJump);
+        exit_jump.first.idx = anchorage.back().first.idx;
+        jump_frame.exits.push_back(dest_->size());
+        dest_->push_back(exit_jump);
+
+        (*dest_)[jump_frame.branch].first.option.jump_target = dest_->size();
+        jump_frame.branch = dest_->size() + anchorage.size() - 1;
       }
 
       if (ast_root == kKeywordContinue || ast_root == kKeywordBreak) {
@@ -1042,7 +1123,10 @@ namespace kagami {
           break;
         }
 
-        anchorage.back().first.option.escape_depth = nest_.size() - cycle_escaper_.top();
+        //Only case block owns a scope among nests inside cycle
+        auto &cycle = cycle_escaper_.top();
+        anchorage.back().first.option.escape_depth = case_nest_ - cycle.case_base;
+        cycle.escapers.push_back(dest_->size() + anchorage.size() - 1);
       }
 
       if (ast_root == kKeywordEnd) {
@@ -1053,17 +1137,34 @@ namespace kagami {
           break;
         }
 
-        if (!cycle_escaper_.empty() && nest_.size() == cycle_escaper_.top())
+        size_t end_idx = dest_->size();
+
+        if (!cycle_escaper_.empty() && nest_.size() == cycle_escaper_.top().nest_depth) {
+          for (auto idx : cycle_escaper_.top().escapers) {
+            (*dest_)[idx].first.option.jump_target = end_idx;
+          }
           cycle_escaper_.pop();
+        }
+
+        (*dest_)[nest_end_.top()].first.option.nest_end = end_idx;
+
+        if (nest_type_.top() == kKeywordFn) {
+          CollectFreeVariables(nest_end_.top(), end_idx);
+        }
 
-        (*dest_)[nest_end_.top()].first.option.nest_end = dest_->size();
         anchorage.back().first.option.nest_root = nest_type_.top();
-        anchorage.back().first.option.nest = nest_.top();
+        //for-each resumes at its own command, the container expression
+        //is evaluated only once.
+        anchorage.back().first.option.nest = nest_type_.top() == kKeywordFor ?
+          nest_end_.top() : nest_.top();
 
         if (compare(nest_type_.top(), kKeywordIf, kKeywordCase) && !jump_stack_.empty()){
-          if (!jump_stack_.top().jump_record.empty()) {
-            dest_->AddJumpRecord(jump_stack_.top().nest, jump_stack_.top().jump_record);
+          auto &jump_frame = jump_stack_.top();
+          (*dest_)[jump_frame.branch].first.option.jump_target = end_idx;
+          for (auto idx : jump_frame.exits) {
+            (*dest_)[idx].first.option.jump_target = end_idx;
           }
+          if (jump_frame.nest_code == kKeywordCase) case_nest_ -= 1;
           jump_stack_.pop();
         }
 
@@ -1090,6 +1191,8 @@ namespace kagami {
       good = false;
     }
 
+    if (good) dest_->Lowering();
+
     return good;
   }
 }
@@ -39,6 +39,8 @@ namespace kagami {
     Token next_2;
     Token last;
     Argument domain;
+    //Index of short-circuit check for pending logic operators
+    stack<size_t> short_circuit;
     deque<Token> &tokens;
 
     ParserFrame(deque<Token> &tokens) :
@@ -54,6 +56,7 @@ namespace kagami {
       next_2(INVALID_TOKEN),
       last(INVALID_TOKEN),
       domain(),
+      short_circuit(),
       tokens(tokens) {}
 
     void Eat();
@@ -101,10 +104,20 @@ namespace kagami {
     Message Make(CombinedToken &line);
   };
 
+  /* Branch targets of if/case block are decided when the next branch or
+     'end' is met. Bodies of branches leave the block by jump commands in
+     exits. */
   struct JumpListFrame {
     Keyword nest_code;
-    size_t nest;
-    list<size_t> jump_record;
+    size_t branch;
+    list<size_t> exits;
+  };
+
+  /* Continue/break commands are waiting for 'end' of innermost cycle */
+  struct CycleFrame {
+    size_t nest_depth;
+    size_t case_base;
+    list<size_t> escapers;
   };
 
   class VMCodeFactory {
@@ -114,10 +127,11 @@ namespace kagami {
     bool inside_struct_;
     bool inside_module_;
     size_t struct_member_fn_nest;
+    size_t case_nest_;
     stack<size_t> nest_;
     stack<size_t> nest_end_;
     stack<size_t> nest_origin_;
-    stack<size_t> cycle_escaper_;
+    stack<CycleFrame> cycle_escaper_;
     stack<Keyword> nest_type_;
     stack<JumpListFrame> jump_stack_;
     list<CombinedCodeline> script_;
@@ -129,6 +143,7 @@ namespace kagami {
 
   private:
     bool ReadScript(list<CombinedCodeline> &dest);
+    void CollectFreeVariables(size_t fn_idx, size_t end_idx);
 
   public:
     ~VMCodeFactory() { if (is_logger_held_) delete logger_; }
@@ -136,7 +151,7 @@ namespace kagami {
     VMCodeFactory(string path, VMCode &dest, 
       string log, bool rtlog = false) :
       dest_(&dest), path_(path), inside_struct_(false), inside_module_(false),
-      struct_member_fn_nest(0),
+      struct_member_fn_nest(0), case_nest_(0),
       logger_(), is_logger_held_(true) {
       logger_ = rtlog ?
         (StandardLogger *)new StandardRTLogger(log.data(), "a") :
@@ -145,7 +160,7 @@ namespace kagami {
     VMCodeFactory(string path, VMCode &dest,
       StandardLogger *logger) :
       dest_(&dest), path_(path), inside_struct_(false), inside_module_(false),
-      struct_member_fn_nest(0),
+      struct_member_fn_nest(0), case_nest_(0),
       logger_(logger), is_logger_held_(false) {}
     
     bool Start();
@@ -5,4 +5,111 @@ namespace kagami {
     vector<string> arg = { id,type_id };
     return Message(CombineStringVector(arg)).SetInvokingSign();
   }
+
+  //Calling C++ function with named arguments. Arguments of positional
+  //function are picked up by parameter names.
+  Message FunctionImpl::CallActivity(ObjectMap &obj_map) {
+    auto &params = meta_->params;
+    string error;
+
+    if (!positional_) {
+      if (HasSignature() && !CheckSignature(obj_map, error)) {
+        return Message(error, kStateError);
+      }
+
+      return GetActivity()(obj_map);
+    }
+
+    vector<Object> args(params.size());
+    Object me;
+
+    for (size_t idx = 0; idx < params.size(); ++idx) {
+      auto it = obj_map.find(params[idx]);
+      if (it != obj_map.end()) args[idx] = it->second;
+    }
+
+    if (auto it = obj_map.find(kStrMe); it != obj_map.end()) me = it->second;
+
+    if (HasSignature() && !CheckSignature(args, error)) {
+      return Message(error, kStateError);
+    }
+
+    ObjectView view(me, args, params);
+    return GetPositionalActivity()(view);
+  }
+
+  //Metadata is shared with copies, it's separated before changing.
+  FunctionMetadata &FunctionImpl::GetMutableMetadata() {
+    if (meta_.use_count() > 1) meta_ = make_shared<FunctionMetadata>(*meta_);
+    return *meta_;
+  }
+
+  FunctionImpl &FunctionImpl::SetSignature(ExpectationList &&lst, NullableList &&nullable) {
+    auto &meta = GetMutableMetadata();
+    auto &params = meta.params;
+    meta.signature.assign(params.size(), nullptr);
+    meta.nullable_mask = 0;
+
+    for (auto &unit : lst) {
+      auto it = std::find(params.begin(), params.end(), unit.first);
+      if (it == params.end()) continue;
+      meta.signature[it - params.begin()] = InternTypeId(unit.second);
+    }
+
+    for (auto &name : nullable) {
+      auto it = std::find(params.begin(), params.end(), name);
+      size_t idx = it - params.begin();
+      if (it == params.end() || idx >= 64) continue;
+      meta.nullable_mask |= (uint64_t(1) << idx);
+    }
+
+    return *this;
+  }
+
+  bool FunctionImpl::CheckSignature(vector<Object> &args, string &error) {
+    auto &signature = meta_->signature;
+
+    for (size_t idx = 0; idx < signature.size(); ++idx) {
+      auto expected = signature[idx];
+      if (expected == nullptr) continue;
+
+      auto &obj = args[idx];
+      if (obj.GetTypeRecord() == expected) continue;
+      if (obj.Null() && idx < 64 && (meta_->nullable_mask >> idx) & 1) continue;
+
+      error = "Expected type is " + expected->name +
+        ", but object type is " + obj.GetTypeId();
+      return false;
+    }
+
+    return true;
+  }
+
+  bool FunctionImpl::CheckSignature(ObjectMap &obj_map, string &error) {
+    auto &signature = meta_->signature;
+    auto &params = meta_->params;
+
+    for (size_t idx = 0; idx < signature.size(); ++idx) {
+      auto expected = signature[idx];
+      if (expected == nullptr) continue;
+
+      bool nullable = idx < 64 && (meta_->nullable_mask >> idx) & 1;
+      auto it = obj_map.find(params[idx]);
+
+      if (it == obj_map.end()) {
+        if (nullable) continue;
+        error = "Argument \"" + params[idx] + "\" is missing";
+        return false;
+      }
+
+      if (it->second.GetTypeRecord() == expected) continue;
+      if (it->second.Null() && nullable) continue;
+
+      error = "Expected type is " + expected->name +
+        ", but object type is " + it->second.GetTypeId();
+      return false;
+    }
+
+    return true;
+  }
 }
\ No newline at end of file
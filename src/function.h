@@ -10,8 +10,12 @@ namespace kagami {
     ReturningTunnel tunnel;
   };
 
-  using Activity = Message(*)(ObjectMap &);  
+  using Activity = Message(*)(ObjectMap &);
+  using PositionalActivity = Message(*)(ObjectView &);
   using ExtensionActivity = int(*)(VMState);
+  using Expect = pair<string, string>;
+  using ExpectationList = initializer_list<Expect>;
+  using NullableList = initializer_list<string>;
 
   enum ParameterPattern {
     kParamAutoSize,
@@ -19,32 +23,48 @@ namespace kagami {
     kParamFixed
   };
 
-  class _FunctionImpl {
-  public:
-    virtual ~_FunctionImpl() {}
-  };
-
-  class CXXFunction : public _FunctionImpl {
+  class CXXFunction {
   private:
     Activity activity_;
+    PositionalActivity positional_activity_;
   public:
     CXXFunction(Activity activity) :
-      activity_(activity) {}
+      activity_(activity), positional_activity_(nullptr) {}
+
+    CXXFunction(PositionalActivity activity) :
+      activity_(nullptr), positional_activity_(activity) {}
 
     Activity GetActivity() const { return activity_; }
+    PositionalActivity GetPositionalActivity() const { return positional_activity_; }
+
+    bool operator==(const CXXFunction &rhs) const {
+      return activity_ == rhs.activity_ &&
+        positional_activity_ == rhs.positional_activity_;
+    }
   };
 
-  class VMCodeFunction : public _FunctionImpl {
+  /* Function body is a range of instructions in compiled unit. Units are
+     held by script storage until the program exits. */
+  class VMCodeFunction {
   private:
-    VMCode code_;
+    VMCode *code_;
+    size_t begin_;
+    size_t end_;
     
   public:
-    VMCodeFunction(VMCode ir) : code_(ir) {}
+    VMCodeFunction(VMCode *code, size_t begin, size_t end) :
+      code_(code), begin_(begin), end_(end) {}
 
-    VMCode &GetCode() { return code_; }
+    VMCode &GetCode() const { return *code_; }
+    size_t GetBegin() const { return begin_; }
+    size_t GetEnd() const { return end_; }
+
+    bool operator==(const VMCodeFunction &rhs) const {
+      return code_ == rhs.code_ && begin_ == rhs.begin_ && end_ == rhs.end_;
+    }
   };
 
-  class ExternalFunction : public _FunctionImpl {
+  class ExternalFunction {
   private:
     ExtensionActivity activity_;
 
@@ -53,35 +73,53 @@ namespace kagami {
       activity_(activity) {}
 
     ExtensionActivity GetExtActivity() const { return activity_; }
+
+    bool operator==(const ExternalFunction &rhs) const {
+      return activity_ == rhs.activity_;
+    }
   };
 
+  //Order of alternatives follows FunctionImplType
   enum FunctionImplType {
-    kFunctionCXX, kFunctionVMCode, kFunctionExternal
+    kFunctionCXX = 1, kFunctionVMCode, kFunctionExternal
+  };
+
+  using FunctionBody = variant<std::monostate, CXXFunction, VMCodeFunction, ExternalFunction>;
+
+  /* Parameter information is decided on registration and shared by all
+     copies of function object. */
+  struct FunctionMetadata {
+    string id;
+    vector<string> params;
+    ParameterPattern mode;
+    size_t limit;
+    //Expected type of each parameter, nullptr for unchecked one
+    vector<TypeId> signature;
+    //Bit N is set if parameter N accepts null object (first 64 only)
+    uint64_t nullable_mask;
+
+    FunctionMetadata(string id = "", vector<string> params = {},
+      ParameterPattern mode = kParamFixed) :
+      id(id), params(params), mode(mode), limit(0),
+      signature(), nullable_mask(0) {}
   };
 
   class FunctionImpl {
   private:
-    shared_ptr<_FunctionImpl> impl_;
-    ObjectMap record_;
+    FunctionBody impl_;
+    bool positional_;
+    shared_ptr<FunctionMetadata> meta_;
+    //Captured objects of closure, shared by copies of function object
+    shared_ptr<ObjectMap> record_;
 
-  private:
-    ParameterPattern mode_;
-    FunctionImplType type_;
-    size_t limit_;
-    size_t offset_;
-    string id_;
-    vector<string> params_;
+    FunctionMetadata &GetMutableMetadata();
 
   public:
     FunctionImpl() :
-      impl_(nullptr),
-      record_(),
-      mode_(),
-      type_(kFunctionCXX),
-      limit_(0),
-      offset_(0),
-      id_(),
-      params_() {}
+      impl_(),
+      positional_(false),
+      meta_(make_shared<FunctionMetadata>()),
+      record_() {}
 
     FunctionImpl(
       Activity activity,
@@ -89,30 +127,34 @@ namespace kagami {
       string id,
       ParameterPattern argument_mode = kParamFixed
     ) :
-      impl_(new CXXFunction(activity)),
-      record_(),
-      mode_(argument_mode),
-      type_(kFunctionCXX),
-      limit_(0),
-      offset_(0),
-      id_(id),
-      params_(BuildStringVector(params)) {}
+      impl_(CXXFunction(activity)),
+      positional_(false),
+      meta_(make_shared<FunctionMetadata>(id, BuildStringVector(params), argument_mode)),
+      record_() {}
+
+    FunctionImpl(
+      PositionalActivity activity,
+      string params,
+      string id,
+      ParameterPattern argument_mode = kParamFixed
+    ) :
+      impl_(CXXFunction(activity)),
+      positional_(true),
+      meta_(make_shared<FunctionMetadata>(id, BuildStringVector(params), argument_mode)),
+      record_() {}
 
     FunctionImpl(
-      size_t offset,
-      VMCode ir,
+      VMCode *code,
+      size_t begin,
+      size_t end,
       string id,
       vector<string> params,
       ParameterPattern argument_mode = kParamFixed
     ) :
-      impl_(new VMCodeFunction(ir)),
-      record_(),
-      mode_(argument_mode),
-      type_(kFunctionVMCode),
-      limit_(0),
-      offset_(offset),
-      id_(id),
-      params_(params) {}
+      impl_(VMCodeFunction(code, begin, end)),
+      positional_(false),
+      meta_(make_shared<FunctionMetadata>(id, std::move(params), argument_mode)),
+      record_() {}
 
     FunctionImpl(
       ExtensionActivity activity,
@@ -120,25 +162,33 @@ namespace kagami {
       string params_pattern,
       ParameterPattern argument_mode = kParamFixed
     ) :
-      impl_(new ExternalFunction(activity)),
-      record_(),
-      mode_(argument_mode),
-      type_(kFunctionExternal),
-      limit_(0),
-      offset_(0),
-      id_(id),
-      params_(BuildStringVector(params_pattern)) {}
+      impl_(ExternalFunction(activity)),
+      positional_(false),
+      meta_(make_shared<FunctionMetadata>(id, BuildStringVector(params_pattern), argument_mode)),
+      record_() {}
 
     VMCode &GetCode() {
-      return dynamic_pointer_cast<VMCodeFunction>(impl_)->GetCode();
+      return std::get<VMCodeFunction>(impl_).GetCode();
+    }
+
+    size_t GetCodeBegin() {
+      return std::get<VMCodeFunction>(impl_).GetBegin();
+    }
+
+    size_t GetCodeEnd() {
+      return std::get<VMCodeFunction>(impl_).GetEnd();
     }
 
     Activity GetActivity() {
-      return dynamic_pointer_cast<CXXFunction>(impl_)->GetActivity();
+      return std::get<CXXFunction>(impl_).GetActivity();
+    }
+
+    PositionalActivity GetPositionalActivity() {
+      return std::get<CXXFunction>(impl_).GetPositionalActivity();
     }
 
     ExtensionActivity GetExtActivity() {
-      return dynamic_pointer_cast<ExternalFunction>(impl_)->GetExtActivity();
+      return std::get<ExternalFunction>(impl_).GetExtActivity();
     }
 
     bool operator==(FunctionImpl &rhs) const {
@@ -146,50 +196,66 @@ namespace kagami {
       return impl_ == rhs.impl_;
     }
 
-    string GetId() const {
-      return id_;
+    const string &GetId() const {
+      return meta_->id;
     }
 
     ParameterPattern GetPattern() const {
-      return mode_;
+      return meta_->mode;
     }
 
-    vector<string> &GetParameters() {
-      return params_;
+    const vector<string> &GetParameters() const {
+      return meta_->params;
     }
 
     FunctionImplType GetType() const {
-      return type_;
+      return static_cast<FunctionImplType>(impl_.index());
+    }
+
+    bool IsPositional() const {
+      return positional_;
+    }
+
+    Message CallActivity(ObjectMap &obj_map);
+
+    //Compile expectations into signature. Unknown names are ignored.
+    FunctionImpl &SetSignature(ExpectationList &&lst, NullableList &&nullable = {});
+    bool CheckSignature(vector<Object> &args, string &error);
+    bool CheckSignature(ObjectMap &obj_map, string &error);
+
+    bool HasSignature() const {
+      return !meta_->signature.empty();
     }
 
     size_t GetParamSize() const {
-      return params_.size();
+      return meta_->params.size();
     }
 
     bool Good() const {
-      return (impl_ != nullptr);
+      return impl_.index() != 0;
     }
 
     FunctionImpl &SetClosureRecord(ObjectMap record) {
-      record_ = record;
+      record_ = make_shared<ObjectMap>(std::move(record));
       return *this;
     }
 
-    ObjectMap &GetClosureRecord() {
+    //nullptr if nothing is captured
+    ObjectMap *GetClosureRecord() {
+      return record_.get();
+    }
+
+    const shared_ptr<ObjectMap> &GetManagedClosureRecord() const {
       return record_;
     }
 
     FunctionImpl &SetLimit(size_t size) {
-      limit_ = size;
+      GetMutableMetadata().limit = size;
       return *this;
     }
 
     size_t GetLimit() const {
-      return limit_;
-    }
-
-    size_t GetOffset() const {
-      return offset_;
+      return meta_->limit;
     }
   };
   
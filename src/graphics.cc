@@ -3,16 +3,6 @@
 namespace kagami {
   //limit:2
   Message NewElement(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("texture", kTypeIdTexture),
-        Expect("dest", kTypeIdRectangle),
-        Expect("src", kTypeIdRectangle)
-      }, p, { "src" }
-    );
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &texture = p.Cast<dawn::Texture>("texture");
     auto &dest = p.Cast<SDL_Rect>("dest");
     auto &src_obj = p["src"];
@@ -35,9 +25,6 @@ namespace kagami {
   }
 
   Message ElementSetPriority(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("priority", kTypeIdInt) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &element = p.Cast<dawn::Element>(kStrMe);
     auto &priority = p.Cast<int64_t>("priority");
     return Message().SetObject(element.SetPriority(int(priority)));
@@ -49,9 +36,6 @@ namespace kagami {
   }
 
   Message ElementSetDest(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("dest", kTypeIdRectangle) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &element = p.Cast<dawn::Element>(kStrMe);
     auto &new_dest = p.Cast<SDL_Rect>("dest");
     auto &dest = element.GetDestInfo();
@@ -61,9 +45,6 @@ namespace kagami {
   }
 
   Message ElementSetSrc(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("src", kTypeIdRectangle) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &element = p.Cast<dawn::Element>(kStrMe);
     auto &new_src = p.Cast<SDL_Rect>("src");
     auto &src = element.GetSrcInfo();
@@ -73,9 +54,6 @@ namespace kagami {
   }
 
   Message ElementSetTexture(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("texture", kTypeIdTexture) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &element = p.Cast<dawn::Element>(kStrMe);
     auto &texture = p.Cast<dawn::Texture>("texture");
     element.SetTexture(texture.Get());
@@ -84,14 +62,6 @@ namespace kagami {
   }
 
   Message NewWindow(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("width", kTypeIdInt),
-        Expect("height", kTypeIdInt)
-      }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &width = p.Cast<int64_t>("width");
     auto &height = p.Cast<int64_t>("height");
     dawn::WindowOption option;
@@ -106,14 +76,6 @@ namespace kagami {
   }
 
   Message WindowAddElement(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("id", kTypeIdString),
-        Expect("element", kTypeIdElement)
-      }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
     auto &element = p.Cast<dawn::Element>("element");
@@ -122,11 +84,6 @@ namespace kagami {
   }
 
   Message WindowGetElementDestination(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("id", kTypeIdString) }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
 
@@ -134,15 +91,6 @@ namespace kagami {
   }
 
   Message WindowSetElementDestination(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("id", kTypeIdString),
-        Expect("dest", kTypeIdRectangle)
-      }, p
-    );
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
     auto &rect = p.Cast<SDL_Rect>("dest");
@@ -151,15 +99,6 @@ namespace kagami {
   }
 
   Message WindowSetElementPosition(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("id", kTypeIdString),
-        Expect("point", kTypeIdPoint)
-      }, p
-    );
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
     auto &point = p.Cast<SDL_Point>("point");
@@ -168,11 +107,6 @@ namespace kagami {
   }
 
   Message WindowGetElementPosition(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("id", kTypeIdString) }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
 
@@ -180,9 +114,6 @@ namespace kagami {
   }
 
   Message WindowSetElementSize(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("id", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
     auto &width = p.Cast<int64_t>("width");
@@ -192,11 +123,6 @@ namespace kagami {
   }
 
   Message WindowGetElementSize(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("id", kTypeIdString) }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
 
@@ -204,14 +130,6 @@ namespace kagami {
   }
 
   Message WindowSetElementCropper(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("id", kTypeIdString),
-        Expect("cropper", kTypeIdRectangle)
-      }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
     auto &cropper = p.Cast<SDL_Rect>("cropper");
@@ -220,11 +138,6 @@ namespace kagami {
   }
 
   Message WindowGetElementCropper(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("id", kTypeIdString) }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
 
@@ -232,14 +145,6 @@ namespace kagami {
   }
 
   Message WindowElementInRange(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("id", kTypeIdString),
-        Expect("point", kTypeIdPoint)
-      }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
     auto &point = p.Cast<SDL_Point>("point");
@@ -248,9 +153,6 @@ namespace kagami {
   }
 
   Message WindowFindElementByPoint(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("point", kTypeIdPoint) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &point = p.Cast<SDL_Point>("point");
     auto *named_element = window.FindElementByPoint(point);
@@ -264,9 +166,6 @@ namespace kagami {
   }
 
   Message WindowDisposeElement(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("id", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
 
@@ -274,9 +173,6 @@ namespace kagami {
   }
 
   Message WindowSetElementOnTop(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("id", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
 
@@ -284,9 +180,6 @@ namespace kagami {
   }
 
   Message WindowSetElementOnBottom(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("id", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &id = p.Cast<string>("id");
 
@@ -294,12 +187,6 @@ namespace kagami {
   }
 
   Message WindowSetElementTexture(ObjectMap &p) {
-    auto tc = TypeChecking({
-      Expect("texture", kTypeIdTexture),
-      Expect("id", kTypeIdString)
-      }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &texture = p.Cast<dawn::Texture>("texture");
     auto &id = p.Cast<string>("id");
@@ -313,9 +200,6 @@ namespace kagami {
   }
 
   Message WindowSetTitle(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("title", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &window = p.Cast<dawn::PlainWindow>(kStrMe);
     auto &title = p.Cast<string>("title");
 
@@ -393,14 +277,6 @@ namespace kagami {
   }
 
   Message NewFont(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("path", kTypeIdString),
-        Expect("size", kTypeIdInt),
-      }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto size = static_cast<int>(p.Cast<int64_t>("size"));
     auto &path = p.Cast<string>("path");
 
@@ -414,14 +290,6 @@ namespace kagami {
   }
 
   Message NewColorValue(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("r", kTypeIdInt), Expect("g", kTypeIdInt),
-        Expect("b", kTypeIdInt), Expect("a", kTypeIdInt)
-      }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto r = static_cast<int>(p.Cast<int64_t>("r"));
     auto g = static_cast<int>(p.Cast<int64_t>("g"));
     auto b = static_cast<int>(p.Cast<int64_t>("b"));
@@ -431,14 +299,6 @@ namespace kagami {
   }
 
   Message NewRectangle(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("x", kTypeIdInt), Expect("y", kTypeIdInt),
-        Expect("width", kTypeIdInt), Expect("height", kTypeIdInt)
-      }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto x = static_cast<int>(p.Cast<int64_t>("x"));
     auto y = static_cast<int>(p.Cast<int64_t>("y"));
     auto w = static_cast<int>(p.Cast<int64_t>("width"));
@@ -450,11 +310,6 @@ namespace kagami {
   }
 
   Message NewPoint(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { Expect("x", kTypeIdInt), Expect("y", kTypeIdInt) }, p);
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto x = static_cast<int>(p.Cast<int64_t>("x"));
     auto y = static_cast<int>(p.Cast<int64_t>("y"));
 
@@ -482,16 +337,6 @@ namespace kagami {
 
   //Limit:3
   Message TextureInitFromImage(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("path", kTypeIdString),
-        Expect("type", kTypeIdInt),
-        Expect("window", kTypeIdWindow),
-        Expect("color_key", kTypeIdColorValue)
-      }, p, { "color_key" });
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &texture = p.Cast<dawn::Texture>(kStrMe);
     auto &image_path = p.Cast<string>("path");
     auto &type = p.Cast<dawn::ImageType>("type");
@@ -512,17 +357,6 @@ namespace kagami {
   }
 
   Message TextureInitFromText(ObjectMap &p) {
-    auto tc = TypeChecking(
-      {
-        Expect("text", kTypeIdString),
-        Expect("font", kTypeIdFont),
-        Expect("window", kTypeIdWindow),
-        Expect("color_key", kTypeIdColorValue),
-        Expect("wrap_length", kTypeIdInt)
-      }, p, { "wrap_length" });
-
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     auto &texture = p.Cast<dawn::Texture>(kStrMe);
     auto &text = p.Cast<string>("text");
     auto &font = p.Cast<dawn::Font>("font");
@@ -645,42 +479,70 @@ namespace kagami {
     ObjectTraitsSetup(kTypeIdElement, PlainDeliveryImpl<dawn::Element>)
       .InitConstructor(
         FunctionImpl(NewElement, "texture|dest|src", "element", kParamAutoFill).SetLimit(2)
+          .SetSignature(
+            {
+              Expect("texture", kTypeIdTexture),
+              Expect("dest", kTypeIdRectangle),
+              Expect("src", kTypeIdRectangle)
+            }, { "src" }
+          )
       )
       .InitMethods(
         {
           FunctionImpl(ElementGetSrcInfo, "", "get_src"),
           FunctionImpl(ElementGetDestInfo, "", "get_dest"),
           FunctionImpl(ElementGetPriority, "", "get_priority"),
-          FunctionImpl(ElementSetPriority, "priority", "set_priority"),
-          FunctionImpl(ElementSetSrc, "src", "set_src"),
-          FunctionImpl(ElementSetDest, "dest", "set_dest"),
+          FunctionImpl(ElementSetPriority, "priority", "set_priority")
+            .SetSignature({ Expect("priority", kTypeIdInt) }),
+          FunctionImpl(ElementSetSrc, "src", "set_src")
+            .SetSignature({ Expect("src", kTypeIdRectangle) }),
+          FunctionImpl(ElementSetDest, "dest", "set_dest")
+            .SetSignature({ Expect("dest", kTypeIdRectangle) }),
           FunctionImpl(ElementSetTexture, "texture", "set_texture")
+            .SetSignature({ Expect("texture", kTypeIdTexture) })
         }
     );
     
     ObjectTraitsSetup(kTypeIdWindow, ShallowDelivery, PointerHasher)
       .InitConstructor(
         FunctionImpl(NewWindow, "width|height", "window")
+          .SetSignature({ Expect("width", kTypeIdInt), Expect("height", kTypeIdInt) })
       )
       .InitMethods(
         {
-          FunctionImpl(WindowAddElement, "id|element", "add_element"),
-          FunctionImpl(WindowGetElementDestination, "id", "get_element_dest"),
-          FunctionImpl(WindowSetElementDestination, "id|dest", "set_element_dest"),
-          FunctionImpl(WindowGetElementPosition, "id", "get_element_position"),
-          FunctionImpl(WindowSetElementPosition, "id|point", "set_element_position"),
-          FunctionImpl(WindowGetElementSize, "id", "get_element_size"),
-          FunctionImpl(WindowSetElementSize, "id|width|height", "set_element_size"),
-          FunctionImpl(WindowGetElementCropper, "id", "get_element_cropper"),
-          FunctionImpl(WindowSetElementCropper, "id|cropper", "set_element_cropper"),
-          FunctionImpl(WindowElementInRange, "id|point", "element_in_range"),
-          FunctionImpl(WindowFindElementByPoint, "point", "shoot"),
-          FunctionImpl(WindowDisposeElement, "id", "dispose"),
-          FunctionImpl(WindowSetElementOnTop, "id", "set_on_top"),
-          FunctionImpl(WindowSetElementOnBottom, "id", "set_on_bottom"),
-          FunctionImpl(WindowSetElementTexture, "id|texture", "set_texture"),
+          FunctionImpl(WindowAddElement, "id|element", "add_element")
+            .SetSignature({ Expect("id", kTypeIdString), Expect("element", kTypeIdElement) }),
+          FunctionImpl(WindowGetElementDestination, "id", "get_element_dest")
+            .SetSignature({ Expect("id", kTypeIdString) }),
+          FunctionImpl(WindowSetElementDestination, "id|dest", "set_element_dest")
+            .SetSignature({ Expect("id", kTypeIdString), Expect("dest", kTypeIdRectangle) }),
+          FunctionImpl(WindowGetElementPosition, "id", "get_element_position")
+            .SetSignature({ Expect("id", kTypeIdString) }),
+          FunctionImpl(WindowSetElementPosition, "id|point", "set_element_position")
+            .SetSignature({ Expect("id", kTypeIdString), Expect("point", kTypeIdPoint) }),
+          FunctionImpl(WindowGetElementSize, "id", "get_element_size")
+            .SetSignature({ Expect("id", kTypeIdString) }),
+          FunctionImpl(WindowSetElementSize, "id|width|height", "set_element_size")
+            .SetSignature({ Expect("id", kTypeIdString) }),
+          FunctionImpl(WindowGetElementCropper, "id", "get_element_cropper")
+            .SetSignature({ Expect("id", kTypeIdString) }),
+          FunctionImpl(WindowSetElementCropper, "id|cropper", "set_element_cropper")
+            .SetSignature({ Expect("id", kTypeIdString), Expect("cropper", kTypeIdRectangle) }),
+          FunctionImpl(WindowElementInRange, "id|point", "element_in_range")
+            .SetSignature({ Expect("id", kTypeIdString), Expect("point", kTypeIdPoint) }),
+          FunctionImpl(WindowFindElementByPoint, "point", "shoot")
+            .SetSignature({ Expect("point", kTypeIdPoint) }),
+          FunctionImpl(WindowDisposeElement, "id", "dispose")
+            .SetSignature({ Expect("id", kTypeIdString) }),
+          FunctionImpl(WindowSetElementOnTop, "id", "set_on_top")
+            .SetSignature({ Expect("id", kTypeIdString) }),
+          FunctionImpl(WindowSetElementOnBottom, "id", "set_on_bottom")
+            .SetSignature({ Expect("id", kTypeIdString) }),
+          FunctionImpl(WindowSetElementTexture, "id|texture", "set_texture")
+            .SetSignature({ Expect("texture", kTypeIdTexture), Expect("id", kTypeIdString) }),
           FunctionImpl(WindowGetId, "", "id"),
-          FunctionImpl(WindowSetTitle, "title", "set_title"),
+          FunctionImpl(WindowSetTitle, "title", "set_title")
+            .SetSignature({ Expect("title", kTypeIdString) }),
           FunctionImpl(WindowDraw, "", "draw"),
           FunctionImpl(WindowWaiting, "", "waiting"),
           FunctionImpl(WindowClear, "", "clear"),
@@ -695,21 +557,39 @@ namespace kagami {
     ObjectTraitsSetup(kTypeIdFont, ShallowDelivery, PointerHasher)
       .InitConstructor(
         FunctionImpl(NewFont, "size|path", "font")
+          .SetSignature({ Expect("path", kTypeIdString), Expect("size", kTypeIdInt) })
     );
 
     ObjectTraitsSetup(kTypeIdColorValue, PlainDeliveryImpl<dawn::ColorValue>)
       .InitConstructor(
         FunctionImpl(NewColorValue, "r|g|b|a", "color")
+          .SetSignature(
+            {
+              Expect("r", kTypeIdInt),
+              Expect("g", kTypeIdInt),
+              Expect("b", kTypeIdInt),
+              Expect("a", kTypeIdInt)
+            }
+          )
     );
 
     ObjectTraitsSetup(kTypeIdRectangle, PlainDeliveryImpl<SDL_Rect>)
       .InitConstructor(
         FunctionImpl(NewRectangle, "x|y|width|height", "rectangle")
+          .SetSignature(
+            {
+              Expect("x", kTypeIdInt),
+              Expect("y", kTypeIdInt),
+              Expect("width", kTypeIdInt),
+              Expect("height", kTypeIdInt)
+            }
+          )
     );
 
     ObjectTraitsSetup(kTypeIdPoint, PlainDeliveryImpl<SDL_Point>)
       .InitConstructor(
         FunctionImpl(NewPoint, "x|y", "point")
+          .SetSignature({ Expect("x", kTypeIdInt), Expect("y", kTypeIdInt) })
       )
       .InitMethods(
         {
@@ -724,8 +604,25 @@ namespace kagami {
       )
       .InitMethods(
         {
-          FunctionImpl(TextureInitFromImage, "path|type|window|color_key", "from_image", kParamAutoFill).SetLimit(3),
-          FunctionImpl(TextureInitFromText, "text|font|window|color_key|wrap_length", "from_text", kParamAutoFill).SetLimit(4),
+          FunctionImpl(TextureInitFromImage, "path|type|window|color_key", "from_image", kParamAutoFill).SetLimit(3)
+            .SetSignature(
+              {
+                Expect("path", kTypeIdString),
+                Expect("type", kTypeIdInt),
+                Expect("window", kTypeIdWindow),
+                Expect("color_key", kTypeIdColorValue)
+              }, { "color_key" }
+            ),
+          FunctionImpl(TextureInitFromText, "text|font|window|color_key|wrap_length", "from_text", kParamAutoFill).SetLimit(4)
+            .SetSignature(
+              {
+                Expect("text", kTypeIdString),
+                Expect("font", kTypeIdFont),
+                Expect("window", kTypeIdWindow),
+                Expect("color_key", kTypeIdColorValue),
+                Expect("wrap_length", kTypeIdInt)
+              }, { "wrap_length" }
+            ),
           FunctionImpl(TextureGood, "", "good"),
           FunctionImpl(TextureHeight, "", "height"),
           FunctionImpl(TextureWidth, "", "width")
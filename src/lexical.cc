@@ -180,6 +180,8 @@ namespace kagami::lexical {
       T(kStrUsingTable     ,kKeywordUsingTable),
       T(kStrApplyLayout    ,kKeywordApplyLayout),
       T(kStrOffensiveMode  ,kKeywordOffensiveMode),
+      T(kStrEventPolling   ,kKeywordEventPolling),
+      T(kStrFrameStats     ,kKeywordFrameStats),
       T(kStrExist          ,kKeywordExist),
       T(kStrStruct         ,kKeywordStruct),
       T(kStrModule         ,kKeywordModule),
@@ -69,11 +69,15 @@ namespace kagami {
     kKeywordUsingTable,
     kKeywordApplyLayout,
     kKeywordOffensiveMode,
+    kKeywordEventPolling,
+    kKeywordFrameStats,
     kKeywordStruct,
     kKeywordModule,
     kKeywordDomainAssertCommand,
     kKeywordInclude, 
     kKeywordSuper,
+    kKeywordShortCircuit,
+    kKeywordJump,
     kKeywordNull
   };
 
@@ -148,6 +152,8 @@ namespace kagami {
     kStrUsingTable     = "using_table",
     kStrApplyLayout    = "apply_layout",
     kStrOffensiveMode  = "offensive_mode",
+    kStrEventPolling   = "event_polling",
+    kStrFrameStats     = "frame_stats",
     kStrPlus           = "+",
     kStrMinus          = "-",
     kStrTimes          = "*",
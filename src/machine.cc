@@ -3,61 +3,136 @@
 namespace kagami {
   using namespace management;
 
-  CommentedResult TypeChecking(ExpectationList &&lst,
-    ObjectMap &obj_map,
-    NullableList &&nullable) {
-    bool result = true;
-    string msg;
-
-    for (auto &unit : lst) {
-#ifdef _MSC_VER
-#pragma warning(disable:4101)
-#endif
-      try {
-        auto &obj = obj_map.at(unit.first);
-        bool founded = (unit.second == obj.GetTypeId());
-        bool null = find_in_list(unit.first, nullable);
+  ForEachCursor::ForEachCursor(CursorType type, Object &container) :
+    type_(type), container_type_(container.Unpack().GetTypeRecord()),
+    base_(nullptr), pinned_(nullptr), idx_(0), table_keys_(), table_it_(), range_() {
+    switch (type_) {
+    case kCursorTable: {
+      auto &table = container.Cast<ObjectTable>();
+      table_keys_.reserve(table.size());
+      for (auto &unit : table) {
+        table_keys_.push_back(unit.first);
+      }
+      break;
+    }
+    case kCursorRange: range_ = container.Cast<IntegerRange>(); break;
+    default: break;
+    }
+  }
 
-        if (founded) continue;
-        else if (null) continue;
-        else {
-          result = false;
-          msg = "Expected type is " + unit.second +
-            ", but object type is " + obj.GetTypeId();
-          break;
-        }
+  ForEachCursor::~ForEachCursor() {
+    if (pinned_ != nullptr) type::UnpinContent(pinned_);
+  }
+
+  //Sizes of array and strings are checked on every step, so the loop body
+  //may resize them. Table is walked over keys taken at the beginning,
+  //because inserting may rehash it. Keys erased by the loop body are
+  //skipped and new keys aren't visited. Content may be replaced by
+  //detaching in the loop body, so it's fetched again here for Unpack().
+  bool ForEachCursor::AtEnd(Object &container) {
+    auto &real = container.Unpack();
+
+    //Loop ends if the variable is assigned with another type
+    if (real.GetTypeRecord() != container_type_) return true;
+
+    switch (type_) {
+    case kCursorArray:
+      base_ = &real.Cast<ObjectArray>();
+      if (base_ != pinned_) {
+        if (pinned_ != nullptr) type::UnpinContent(pinned_);
+        type::PinContent(base_);
+        pinned_ = base_;
       }
-      catch (std::out_of_range &e) {
-        if (find_in_list(unit.first, nullable)) continue;
-        else {
-          result = false;
-          msg = "Argument \"" + unit.first + "\" is missing";
-          break;
+      break;
+    case kCursorString: base_ = &real.Cast<string>(); break;
+    case kCursorWideString: base_ = &real.Cast<wstring>(); break;
+    case kCursorTable: base_ = &real.Cast<ObjectTable>(); break;
+    default: break;
+    }
+
+    switch (type_) {
+    case kCursorArray: return idx_ >= static_cast<ObjectArray *>(base_)->size();
+    case kCursorString: return idx_ >= static_cast<string *>(base_)->size();
+    case kCursorWideString: return idx_ >= static_cast<wstring *>(base_)->size();
+    case kCursorTable: {
+      auto &table = *static_cast<ObjectTable *>(base_);
+
+      for (; idx_ < table_keys_.size(); ++idx_) {
+        //Found entry is used by Unpack() right after this
+        if (table_it_ = table.find(table_keys_[idx_]); table_it_ != table.end()) {
+          return false;
         }
       }
-      catch (...) {
-        result = false;
-        msg = "Internal error";
-        break;
-      }
-#ifdef _MSC_VER
-#pragma warning(default:4101)
-#endif
+
+      return true;
+    }
+    case kCursorRange:
+      return range_.step > 0 ? range_.start >= range_.stop : range_.start <= range_.stop;
+    default: break;
     }
 
-    return { result, msg };
+    return true;
   }
 
+  void ForEachCursor::StepForward() {
+    if (type_ == kCursorRange) {
+      //Last step may pass over stop and overflow, so stop is taken instead
+      if (range_.StepLength() >= range_.Distance()) range_.start = range_.stop;
+      else range_.start += range_.step;
+    }
+    else idx_ += 1;
+  }
 
-  PlainType FindTypeCode(string type_id) {
-    PlainType type = kNotPlainType;
+  Object ForEachCursor::Unpack() {
+    switch (type_) {
+    case kCursorArray:
+      return Object().PackObject((*static_cast<ObjectArray *>(base_))[idx_]);
+    case kCursorString:
+      return Object(string(1, (*static_cast<string *>(base_))[idx_]));
+    case kCursorWideString:
+      return Object(make_shared<wstring>(1, (*static_cast<wstring *>(base_))[idx_]),
+        kTypeIdWideString);
+    case kCursorTable: {
+      Object key = table_it_->first;
+      ManagedPair base = make_shared<ObjectPair>(
+        type::CreateObjectCopy(key),
+        type::CreateObjectCopy(table_it_->second));
+      return Object(base, kTypeIdPair);
+    }
+    case kCursorRange: return Object(range_.start, GetInlineTypeId(kInlineInt));
+    default: break;
+    }
 
-    if (type_id == kTypeIdInt) type = kPlainInt;
-    if (type_id == kTypeIdFloat) type = kPlainFloat;
-    if (type_id == kTypeIdString) type = kPlainString;
-    if (type_id == kTypeIdBool) type = kPlainBool;
+    return Object();
+  }
+
+  //Returns nullptr for user-defined containers.
+  shared_ptr<ForEachCursor> CreateForEachCursor(Object &container) {
+    static TypeId array_type = InternTypeId(kTypeIdArray);
+    static TypeId table_type = InternTypeId(kTypeIdTable);
+    static TypeId wstring_type = InternTypeId(kTypeIdWideString);
+    static TypeId range_type = InternTypeId(kTypeIdRange);
+    auto type = container.GetTypeRecord();
+
+    //Loop unit is bound to elements by reference
+    if (type == array_type) {
+      type::DetachSharedContent(container);
+      return make_shared<ForEachCursor>(kCursorArray, container);
+    }
+    if (type == table_type)
+      return make_shared<ForEachCursor>(kCursorTable, container);
+    if (type == GetStringTypeId())
+      return make_shared<ForEachCursor>(kCursorString, container);
+    if (type == wstring_type)
+      return make_shared<ForEachCursor>(kCursorWideString, container);
+    if (type == range_type)
+      return make_shared<ForEachCursor>(kCursorRange, container);
 
-    return type;
+    return nullptr;
+  }
+
+  PlainType FindTypeCode(TypeId type) {
+    return type->plain_type;
   }
 
   bool IsIllegalStringOperator(Keyword keyword) {
@@ -66,9 +141,39 @@ namespace kagami {
       keyword != kKeywordEquals;
   }
 
+  //Pick specialized form of operator instruction from observed operands
+  OperandSpecialization SpecializeOperands(PlainType lhs, PlainType rhs, Keyword keyword) {
+    if (lhs != rhs) return kSpecializeGeneric;
+
+    switch (lhs) {
+    case kPlainInt: return kSpecializeInt;
+    case kPlainFloat: return kSpecializeFloat;
+    case kPlainString: 
+      return IsIllegalStringOperator(keyword) ? kSpecializeGeneric : kSpecializeString;
+    default: break;
+    }
+
+    return kSpecializeGeneric;
+  }
+
+  //Guard of specialized operator instruction
+  bool MatchSpecialization(OperandSpecialization spec, Object &lhs, Object &rhs) {
+    PlainType expected = kNotPlainType;
+
+    switch (spec) {
+    case kSpecializeInt: expected = kPlainInt; break;
+    case kSpecializeFloat: expected = kPlainFloat; break;
+    case kSpecializeString: expected = kPlainString; break;
+    default: return false;
+    }
+
+    return lhs.GetTypeRecord()->plain_type == expected &&
+      rhs.GetTypeRecord()->plain_type == expected;
+  }
+
   int64_t IntProducer(Object &obj) {
     int64_t result = 0;
-    switch (auto type = FindTypeCode(obj.GetTypeId()); type) {
+    switch (auto type = FindTypeCode(obj.GetTypeRecord()); type) {
     case kPlainInt:result = obj.Cast<int64_t>(); break;
     case kPlainFloat:result = static_cast<int64_t>(obj.Cast<double>()); break;
     case kPlainBool:result = obj.Cast<bool>() ? 1 : 0; break;
@@ -80,7 +185,7 @@ namespace kagami {
 
   double FloatProducer(Object &obj) {
     double result = 0;
-    switch (auto type = FindTypeCode(obj.GetTypeId()); type) {
+    switch (auto type = FindTypeCode(obj.GetTypeRecord()); type) {
     case kPlainFloat:result = obj.Cast<double>(); break;
     case kPlainInt:result = static_cast<double>(obj.Cast<int64_t>()); break;
     case kPlainBool:result = obj.Cast<bool>() ? 1.0 : 0.0; break;
@@ -92,7 +197,7 @@ namespace kagami {
 
   string StringProducer(Object &obj) {
     string result;
-    switch (auto type = FindTypeCode(obj.GetTypeId()); type) {
+    switch (auto type = FindTypeCode(obj.GetTypeRecord()); type) {
     case kPlainInt:result = to_string(obj.Cast<int64_t>()); break;
     case kPlainFloat:result = to_string(obj.Cast<double>()); break;
     case kPlainBool:result = obj.Cast<bool>() ? kStrTrue : kStrFalse; break;
@@ -104,7 +209,7 @@ namespace kagami {
   }
 
   bool BoolProducer(Object &obj) {
-    auto type = FindTypeCode(obj.GetTypeId());
+    auto type = FindTypeCode(obj.GetTypeRecord());
     bool result = false;
 
     if (type == kPlainInt) {
@@ -126,12 +231,6 @@ namespace kagami {
     return result;
   }
   
-  string ParseRawString(const string & src) {
-    string result = src;
-    if (lexical::IsString(result)) result = lexical::GetRawString(result);
-    return result;
-  }
-
   void InitPlainTypesAndConstants() {
     using type::ObjectTraitsSetup;
     using namespace management;
@@ -166,16 +265,16 @@ namespace kagami {
 
     if (type == kExtTypeInt) {
       auto *ret_value = static_cast<int64_t *>(value);
-      slot_obj.PackContent(make_shared<int64_t>(*ret_value), kTypeIdInt);
+      slot_obj.PackValue(*ret_value, kTypeIdInt);
     }
     else if (type == kExtTypeFloat) {
       auto *ret_value = static_cast<double *>(value);
-      slot_obj.PackContent(make_shared<double>(*ret_value), kTypeIdFloat);
+      slot_obj.PackValue(*ret_value, kTypeIdFloat);
     }
     else if (type == kExtTypeBool) {
       auto *ret_value = static_cast<int *>(value);
       bool content = *ret_value == 1 ? true : false;
-      slot_obj.PackContent(make_shared<bool>(content), kTypeIdBool);
+      slot_obj.PackValue(content, kTypeIdBool);
     }
     else if (type == kExtTypeString) {
       const auto *ret_value = static_cast<char *>(value);
@@ -213,20 +312,82 @@ namespace kagami {
     machine.PushError(string(msg));
   }
 
+  void RedrawScheduler::Start(int64_t frame_rate) {
+    if (frame_rate <= 0) {
+      SDL_DisplayMode mode;
+      frame_rate = SDL_GetCurrentDisplayMode(0, &mode) == 0 && mode.refresh_rate > 0 ?
+        mode.refresh_rate : kDefaultFrameRate;
+    }
+
+    interval_ = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::seconds(1)) / frame_rate;
+    next_frame_ = Clock::now();
+    last_frame_ = Clock::time_point();
+    frame_rate_ = frame_rate;
+    countdown_ = 1;
+    pending_ = false;
+    frames_ = 0;
+    last_frame_time_ = Clock::duration::zero();
+    total_frame_time_ = Clock::duration::zero();
+    max_frame_time_ = Clock::duration::zero();
+    draw_time_ = Clock::duration::zero();
+  }
+
+  void RedrawScheduler::Present(Clock::time_point now) {
+    dawn::ForceRefreshingAllWindow();
+    pending_ = false;
+
+    auto end = Clock::now();
+    draw_time_ = end - now;
+
+    if (frames_ > 0) {
+      last_frame_time_ = now - last_frame_;
+      total_frame_time_ += last_frame_time_;
+      max_frame_time_ = std::max(max_frame_time_, last_frame_time_);
+    }
+
+    frames_ += 1;
+    last_frame_ = now;
+    next_frame_ += interval_;
+
+    //Skip missed frames instead of presenting them in a burst
+    if (next_frame_ <= end) next_frame_ = end + interval_;
+  }
+
+  //Durations are in milliseconds
+  Object RedrawScheduler::GetStatistics() const {
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    ManagedTable table = make_shared<ObjectTable>();
+    double average = frames_ > 1 ?
+      Milliseconds(total_frame_time_).count() / (frames_ - 1) : 0.0;
+
+    auto insert = [&table](string key, Object value) -> void {
+      table->insert(make_pair(Object(key), value));
+    };
+
+    insert("frames", Object(static_cast<int64_t>(frames_), kTypeIdInt));
+    insert("frame_rate", Object(static_cast<int64_t>(frame_rate_), kTypeIdInt));
+    insert("frame_time", Object(Milliseconds(last_frame_time_).count(), kTypeIdFloat));
+    insert("average_frame_time", Object(average, kTypeIdFloat));
+    insert("max_frame_time", Object(Milliseconds(max_frame_time_).count(), kTypeIdFloat));
+    insert("draw_time", Object(Milliseconds(draw_time_).count(), kTypeIdFloat));
+
+    return Object(table, kTypeIdTable);
+  }
+
   void RuntimeFrame::Stepping() {
     if (!disable_step) idx += 1;
     disable_step = false;
   }
 
   void RuntimeFrame::Goto(size_t target_idx) {
-    idx = target_idx - jump_offset;
+    idx = target_idx;
     disable_step = true;
   }
 
-  void RuntimeFrame::AddJumpRecord(size_t target_idx) {
-    if (jump_stack.empty() || jump_stack.top() != target_idx) {
-      jump_stack.push(target_idx);
-    }
+  void RuntimeFrame::SetCodeRange(size_t begin, size_t end) {
+    idx = begin;
+    code_end = end;
   }
 
   void RuntimeFrame::MakeError(string str) {
@@ -239,9 +400,41 @@ namespace kagami {
     msg_string = str;
   }
 
-  void RuntimeFrame::RefreshReturnStack(Object obj) {
+  void RuntimeFrame::Reset(OperandStack &operands) {
+    error = false;
+    warning = false;
+    activated_continue = false;
+    activated_break = false;
+    void_call = false;
+    disable_step = false;
+    final_cycle = false;
+    jump_from_end = false;
+    event_processing = false;
+    initializer_calling = false;
+    inside_initializer_calling = false;
+    struct_base = Object();
+    assert_rc_copy = Object();
+    code_end = 0;
+    idx = 0;
+    msg_string.clear();
+    function_scope.clear();
+    struct_id.clear();
+    super_struct_id.clear();
+    this->operands = &operands;
+    stack_base = operands.Size();
+    slots.clear();
+    local_slots.clear();
+  }
+
+  void RuntimeFrame::RefreshReturnStack(const Object &obj) {
     if (!void_call) {
-      return_stack.push(std::move(obj));
+      operands->Push(obj);
+    }
+  }
+
+  void RuntimeFrame::RefreshReturnStack(Object &&obj) {
+    if (!void_call) {
+      operands->Push(std::move(obj));
     }
   }
 
@@ -751,11 +944,15 @@ namespace kagami {
     if (window.GetRefreshingMode()) window.DrawElements();
   }
 
+  //Returning value is pushed by caller of this function
   void Machine::RecoverLastState() {
+    //Changes made by event handler are shown before waiting for next event
+    if (offensive_ && frame_stack_.top().event_processing) redraw_.Flush();
+
+    frame_stack_.top().ClearReturnStack();
     frame_stack_.pop();
     code_stack_.pop_back();
     obj_stack_.Pop();
-    frame_stack_.top().RefreshReturnStack();
   }
 
   void Machine::FinishInitalizerCalling() {
@@ -765,22 +962,26 @@ namespace kagami {
     frame_stack_.top().RefreshReturnStack(instance_obj);
   }
 
-  bool Machine::IsTailRecursion(size_t idx, VMCode *code) {
-    if (code != code_stack_.back()) return false;
+  //Function bodies end at different 'end' command of the unit
+  bool Machine::IsTailRecursion(size_t idx, FunctionImpl &impl) {
+    if (&impl.GetCode() != code_stack_.back()) return false;
+    if (impl.GetCodeEnd() != frame_stack_.top().code_end) return false;
 
-    auto &vmcode = *code;
-    auto &current = vmcode[idx];
+    auto &vmcode = *code_stack_.back();
+    auto &current = vmcode.GetInstruction(idx);
+    size_t size = frame_stack_.top().code_end;
     bool result = false;
 
-    if (idx == vmcode.size() - 1) {
+    if (idx == size - 1) {
       result = true;
     }
-    else if (idx == vmcode.size() - 2) {
+    else if (idx == size - 2) {
+      auto &next = vmcode.GetInstruction(idx + 1);
       bool needed_by_next_call =
-        vmcode[idx + 1].first.GetKeywordValue() == kKeywordReturn &&
-        vmcode[idx + 1].second.back().GetType() == kArgumentReturnStack &&
-        vmcode[idx + 1].second.size() == 1;
-      if (!current.first.option.void_call && needed_by_next_call) {
+        next.keyword == kKeywordReturn &&
+        next.arg_size == 1 &&
+        vmcode.GetArguments(next).back().GetType() == kArgumentReturnStack;
+      if (!current.option.void_call && needed_by_next_call) {
         result = true;
       }
     }
@@ -791,17 +992,19 @@ namespace kagami {
   bool Machine::IsTailCall(size_t idx) {
     if (frame_stack_.size() <= 1) return false;
     auto &vmcode = *code_stack_.back();
+    size_t size = frame_stack_.top().code_end;
     bool result = false;
 
-    if (idx == vmcode.size() - 1) {
+    if (idx == size - 1) {
       result = true;
     }
-    else if (idx == vmcode.size() - 2) {
+    else if (idx == size - 2) {
+      auto &next = vmcode.GetInstruction(idx + 1);
       bool needed_by_next_call = 
-        vmcode[idx + 1].first.GetKeywordValue() == kKeywordReturn &&
-        vmcode[idx + 1].second.back().GetType() == kArgumentReturnStack &&
-        vmcode[idx + 1].second.size() == 1;
-      if (!vmcode[idx].first.option.void_call && needed_by_next_call) {
+        next.keyword == kKeywordReturn &&
+        next.arg_size == 1 &&
+        vmcode.GetArguments(next).back().GetType() == kArgumentReturnStack;
+      if (!vmcode.GetInstruction(idx).option.void_call && needed_by_next_call) {
         result = true;
       }
     }
@@ -810,42 +1013,7 @@ namespace kagami {
   }
 
   Object Machine::FetchPlainObject(Argument &arg) {
-    auto type = arg.GetStringType();
-    auto value = arg.GetData();
-    Object obj;
-
-    if (type == kStringTypeInt) {
-      int64_t int_value;
-      from_chars(value.data(), value.data() + value.size(), int_value);
-      obj.PackContent(make_shared<int64_t>(int_value), kTypeIdInt);
-    }
-    else if (type == kStringTypeFloat) {
-      double float_value;
-#ifndef _MSC_VER
-      //dealing with issues of charconv implementation in low-version clang
-      float_value = stod(value);
-#else
-      from_chars(value.data(), value.data() + value.size(), float_value);
-#endif
-      obj.PackContent(make_shared<double>(float_value), kTypeIdFloat);
-    }
-    else {
-      switch (type) {
-      case kStringTypeBool:
-        obj.PackContent(make_shared<bool>(value == kStrTrue), kTypeIdBool);
-        break;
-      case kStringTypeString:
-        obj.PackContent(make_shared<string>(ParseRawString(value)), kTypeIdString);
-        break;
-      case kStringTypeIdentifier:
-        obj.PackContent(make_shared<string>(value), kTypeIdString);
-        break;
-      default:
-        break;
-      }
-    }
-
-    return obj;
+    return code_stack_.back()->GetConstant(arg);
   }
 
   Object Machine::FetchFunctionObject(string id) {
@@ -861,13 +1029,58 @@ namespace kagami {
     return obj;
   }
 
+  //Variable lookup through frame slot. Name lookup is used again only
+  //when scope layout is changed since last resolving. Local slots are
+  //checked directly, outer slots walk the scopes between lookup start
+  //and owner.
+  Object *Machine::FindObjectBySlot(const string &id, size_t slot, bool local) {
+    if (slot == kInvalidSlot) return obj_stack_.Find(id);
+
+    if (obj_stack_.GetBase().empty()) return obj_stack_.Find(id);
+
+    auto *scope = &obj_stack_.GetCurrent();
+
+    if (local) {
+      auto &local_slots = frame_stack_.top().local_slots;
+      if (slot >= local_slots.size()) local_slots.resize(slot + 1);
+      auto &record = local_slots[slot];
+
+      if (record.scope == scope && scope->IsBoundLookupValid(record.owner, record.stamp)) {
+        return record.ptr;
+      }
+
+      record.ptr = obj_stack_.FindWithOwner(id, record.owner);
+      record.scope = record.owner != nullptr ? scope : nullptr;
+      record.stamp = ObjectContainer::GetLayoutClock();
+      return record.ptr;
+    }
+
+    auto &slots = frame_stack_.top().slots;
+
+    if (slot >= slots.size()) slots.resize(slot + 1);
+
+    auto &record = slots[slot];
+
+    if (record.scope == scope &&
+      scope->IsLookupValid(record.owner, record.name_bit, record.stamp)) {
+      return record.ptr;
+    }
+
+    if (record.name_bit == 0) record.name_bit = ObjectContainer::GetNameBit(id);
+
+    record.ptr = obj_stack_.FindWithOwner(id, record.owner);
+    //Objects from outside of scope chain are looked up again every time
+    record.scope = record.owner != nullptr ? scope : nullptr;
+    record.stamp = ObjectContainer::GetLayoutClock();
+    return record.ptr;
+  }
+
   Object Machine::FetchObject(Argument &arg, bool checking) {
     if (arg.GetType() == kArgumentNormal) {
       return FetchPlainObject(arg).SetDeliveringFlag();
     }
 
     auto &frame = frame_stack_.top();
-    auto &return_stack = frame.return_stack;
     ObjectPointer ptr = nullptr;
     Object obj;
 
@@ -887,6 +1100,11 @@ namespace kagami {
           if (arg.option.assert_chain_tail) frame.assert_rc_copy = Object();
         }
         else if (arg.option.domain_type == kArgumentObjectStack) {
+          //Member is going to be referenced, instance can't be shared anymore
+          if (auto *domain_ptr = obj_stack_.Find(arg.option.domain); domain_ptr != nullptr) {
+            type::DetachSharedContent(*domain_ptr);
+          }
+
           ptr = obj_stack_.Find(arg.GetData(), arg.option.domain);
 
           if (ptr != nullptr) obj.PackObject(*ptr);
@@ -896,15 +1114,15 @@ namespace kagami {
           }
         }
         else if (arg.option.domain_type == kArgumentReturnStack) {
-          auto &sub_container = return_stack.top().Cast<ObjectStruct>();
+          auto &sub_container = frame.ReturnStackTop().Cast<ObjectStruct>();
           ptr = sub_container.Find(arg.GetData());
           //keep object alive
           if (ptr != nullptr) obj = *ptr;
-          return_stack.pop();
+          frame.PopReturnStack();
         }
       }
       else {
-        if (ptr = obj_stack_.Find(arg.GetData()); ptr != nullptr) {
+        if (ptr = FindObjectBySlot(arg.GetData(), arg.GetSlot(), arg.IsLocalSlot()); ptr != nullptr) {
           obj.PackObject(*ptr);
           return obj;
         }
@@ -919,10 +1137,12 @@ namespace kagami {
       }
     }
     else if (arg.GetType() == kArgumentReturnStack) {
-      if (!return_stack.empty()) {
-        obj = return_stack.top();
+      if (!frame.ReturnStackEmpty()) {
+        //Top object is going to be popped, so it can be moved out.
+        if (checking) obj = frame.ReturnStackTop();
+        else obj = std::move(frame.ReturnStackTop());
         obj.SetDeliveringFlag();
-        if(!checking) return_stack.pop(); 
+        if(!checking) frame.PopReturnStack(); 
       }
       else {
         frame.MakeError("Can't get object from stack.");
@@ -959,14 +1179,43 @@ namespace kagami {
     return false;
   }
 
-  bool Machine::FetchFunctionImpl(FunctionImplPointer &impl, CommandPointer &command, ObjectMap &obj_map) {
+  //Query built-in function through inline cache of current call site.
+  //Caches are refreshed after new implementation is created.
+  FunctionImpl *Machine::FindFunctionByCache(Instruction &inst, const string &id,
+    TypeId type) {
+    auto &cache = inst.cache;
+    auto version = GetImplVersion();
+
+    if (cache.version != version) {
+      cache.version = version;
+      cache.size = 0;
+      cache.next = 0;
+    }
+
+    for (size_t idx = 0; idx < cache.size; ++idx) {
+      if (cache.entries[idx].type == type) return cache.entries[idx].impl;
+    }
+
+    auto *impl = FindFunction(id, type->name);
+    size_t dest = cache.size < kCallSiteCacheSize ?
+      cache.size++ : cache.next++ % kCallSiteCacheSize;
+
+    cache.entries[dest].type = type;
+    cache.entries[dest].impl = impl;
+    return impl;
+  }
+
+  //Receiver of method calling is stored in me.
+  bool Machine::FetchFunctionImpl(FunctionImplPointer &impl, InstructionPointer &inst, Object &me) {
+    static TypeId null_type = InternTypeId(kTypeIdNull);
     auto &frame = frame_stack_.top();
-    auto id = command->first.GetInterfaceId();
-    auto domain = command->first.GetInterfaceDomain();
+    auto &code = *code_stack_.back();
+    auto &id = code.GetIdentifier(*inst);
+    auto &domain = code.GetDomain(*inst);
     
     if (domain.GetType() != kArgumentNull || 
-      command->first.option.use_last_assert) {
-      Object obj = command->first.option.use_last_assert ?
+      inst->option.use_last_assert) {
+      Object obj = inst->option.use_last_assert ?
         frame.assert_rc_copy :
         FetchObject(domain, true);
 
@@ -974,7 +1223,7 @@ namespace kagami {
 
       //find method in sub-container    
       if (obj.IsSubContainer()) {
-        impl = mgmt::FindFunction(id, obj.GetTypeId());
+        impl = FindFunctionByCache(*inst, id, obj.GetTypeRecord());
 
         if (impl == nullptr) {
           auto &base = obj.Cast<ObjectStruct>();
@@ -989,23 +1238,23 @@ namespace kagami {
           }
 
           impl = &ptr->Cast<FunctionImpl>();
-          obj_map.emplace(NamedObject(kStrMe, obj));
+          me = obj;
           if (!frame.assert_rc_copy.Null()) frame.assert_rc_copy = Object();
           return true;
         }
         else {
-          obj_map.emplace(NamedObject(kStrMe, obj));
+          me = obj;
           if (!frame.assert_rc_copy.Null()) frame.assert_rc_copy = Object();
           return true;
         }
       }
 
-      if (impl = mgmt::FindFunction(id, obj.GetTypeId()); impl == nullptr) {
+      if (impl = FindFunctionByCache(*inst, id, obj.GetTypeRecord()); impl == nullptr) {
         frame.MakeError("Method is not found - " + id);
         return false;
       }
 
-      obj_map.emplace(NamedObject(kStrMe, obj));
+      me = obj;
       if (!frame.assert_rc_copy.Null()) frame.assert_rc_copy = Object();
       return true;
     }
@@ -1013,11 +1262,11 @@ namespace kagami {
     //At first, Machine will querying in built-in function map,
     //and then try to fetch function object in heap.
     else {
-      if (impl = FindFunction(id); impl != nullptr) {
+      if (impl = FindFunctionByCache(*inst, id, null_type); impl != nullptr) {
         return true;
       }
 
-      ObjectPointer ptr = obj_stack_.Find(id);
+      ObjectPointer ptr = FindObjectBySlot(id, inst->slot, inst->local_slot);
 
       if (ptr != nullptr) {
         if (ptr->GetTypeId() == kTypeIdFunction) {
@@ -1046,19 +1295,14 @@ namespace kagami {
     return false;
   }
 
-  void Machine::ClosureCatching(ArgumentList &args, size_t nest_end, bool closure) {
+  void Machine::ClosureCatching(ArgumentView &args, RequestOption &option, bool closure) {
     auto &frame = frame_stack_.top();
     auto &obj_list = obj_stack_.GetBase();
     auto &origin_code = *code_stack_.back();
-    size_t counter = 0, size = args.size(), nest = frame.idx;
+    size_t counter = 0, size = args.size(), nest = frame.idx, nest_end = option.nest_end;
     bool optional = false, variable = false;
     ParameterPattern argument_mode = kParamFixed;
     vector<string> params;
-    VMCode code(&origin_code);
-
-    for (size_t idx = nest + 1; idx < nest_end - frame.jump_offset; ++idx) {
-      code.push_back(origin_code[idx]);
-    }
 
     for (size_t idx = 1; idx < size; idx += 1) {
       auto id = args[idx].GetData();
@@ -1076,34 +1320,32 @@ namespace kagami {
     if (optional) argument_mode = kParamAutoFill;
     if (variable) argument_mode = kParamAutoSize;
 
-    FunctionImpl impl(nest + 1, code, args[0].GetData(), params, argument_mode);
+    FunctionImpl impl(&origin_code, nest + 1, nest_end, args[0].GetData(), params, argument_mode);
 
     if (optional) {
       impl.SetLimit(params.size() - counter);
     }
 
-    //TODO:Object Selection
+    //Only free variables of function body are captured, searching scopes
+    //up to the innermost function scope.
     if (closure) {
       ObjectMap scope_record;
       auto &base = obj_stack_.GetBase();
-      auto it = base.rbegin();
-      bool flag = false;
 
-      for (; it != base.rend(); ++it) {
-        if (flag) break;
+      for (auto &id : origin_code.GetFreeVariables(nest)) {
+        if (id == kStrThisWindow) continue;
 
-        if (it->Find(kStrUserFunc) != nullptr) flag = true;
-
-        for (auto &unit : it->GetContent()) {
-          if (unit.first == kStrThisWindow) continue;
-          if (scope_record.find(unit.first) == scope_record.end()) {
-            scope_record.insert(NamedObject(unit.first,
-              type::CreateObjectCopy(unit.second)));
+        for (auto it = base.rbegin(); it != base.rend(); ++it) {
+          if (auto *ptr = it->Find(id, false); ptr != nullptr) {
+            scope_record.insert(NamedObject(id, type::CreateObjectCopy(*ptr)));
+            break;
           }
+
+          if (it->Find(kStrUserFunc, false) != nullptr) break;
         }
       }
 
-      impl.SetClosureRecord(scope_record);
+      impl.SetClosureRecord(std::move(scope_record));
     }
 
     obj_stack_.CreateObject(args[0].GetData(),
@@ -1125,31 +1367,30 @@ namespace kagami {
     obj_map.insert(NamedObject(kStrMe, obj));
 
     if (impl->GetType() == kFunctionVMCode) {
-      Run(true, id, &impl->GetCode(), &obj_map, &impl->GetClosureRecord());
-      Object obj = frame_stack_.top().return_stack.top();
-      frame_stack_.top().return_stack.pop();
-      return Message().SetObject(obj);
-    }
+      size_t stack_size = operand_stack_.Size();
+      Object ret_obj;
+      Run(true, id, impl, &obj_map);
 
-    auto activity = impl->GetActivity();
+      if (operand_stack_.Size() > stack_size) {
+        ret_obj = operand_stack_.Top();
+        operand_stack_.Pop();
+      }
 
-    return activity(obj_map);
+      return Message().SetObject(ret_obj);
+    }
+
+    return impl->CallActivity(obj_map);
   }
 
-  void Machine::CommandIfOrWhile(Keyword token, ArgumentList &args, size_t nest_end) {
+  //Target is next branch of if block or end of while block
+  void Machine::CommandIfOrWhile(Keyword token, ArgumentView &args, size_t target) {
     auto &frame = frame_stack_.top();
-    auto &code = code_stack_.front();
 
     if (!EXPECTED_COUNT(1)) {
       frame.MakeError("Argument for condition is missing");
       return;
     }
 
-    if (token == kKeywordIf || token == kKeywordWhile) {
-      frame.AddJumpRecord(nest_end);
-      code->FindJumpRecord(frame.idx + frame.jump_offset, frame.branch_jump_stack);
-    }
-    
     Object obj = FetchObject(args[0]);
 
     if (obj.GetTypeId() != kTypeIdBool) {
@@ -1159,46 +1400,8 @@ namespace kagami {
 
     bool state = obj.Cast<bool>();
 
-    if (token == kKeywordIf) {
-      frame.scope_stack.push(false);
-      frame.condition_stack.push(state);
-      if (!state) {
-        if (frame.branch_jump_stack.empty()) {
-          frame.Goto(frame.jump_stack.top());
-        }
-        else {
-          frame.Goto(frame.branch_jump_stack.top());
-          frame.branch_jump_stack.pop();
-        }
-      }
-    }
-    else if (token == kKeywordElif) {
-      if (frame.condition_stack.empty()) {
-        frame.MakeError("Unexpected Elif");
-        return;
-      }
-
-      if (frame.condition_stack.top()) {
-        frame.Goto(frame.jump_stack.top());
-      }
-      else {
-        if (state) {
-          frame.condition_stack.top() = true;
-        }
-        else {
-          if (frame.branch_jump_stack.empty()) {
-            frame.Goto(frame.jump_stack.top());
-          }
-          else {
-            frame.Goto(frame.branch_jump_stack.top());
-            frame.branch_jump_stack.pop();
-          }
-        }
-      }
-    }
-    else if (token == kKeywordWhile) {
+    if (token == kKeywordWhile) {
       if (!frame.jump_from_end) {
-        frame.scope_stack.push(true);
         obj_stack_.Push();
       }
       else {
@@ -1206,18 +1409,19 @@ namespace kagami {
       }
 
       if (!state) {
-        frame.Goto(nest_end);
+        frame.Goto(target);
         frame.final_cycle = true;
       }
     }
+    else if (!state) {
+      frame.Goto(target);
+    }
   }
 
-  void Machine::CommandForEach(ArgumentList &args, size_t nest_end) {
+  void Machine::CommandForEach(ArgumentView &args, size_t nest_end) {
     auto &frame = frame_stack_.top();
     ObjectMap obj_map;
 
-    frame.AddJumpRecord(nest_end);
-
     if (frame.jump_from_end) {
       ForEachChecking(args, nest_end);
       frame.jump_from_end = false;
@@ -1227,6 +1431,21 @@ namespace kagami {
     auto unit_id = FetchObject(args[0]).Cast<string>();
     auto container_obj = FetchObject(args[1]);
 
+    if (auto cursor = CreateForEachCursor(container_obj); cursor != nullptr) {
+      if (cursor->AtEnd(container_obj)) {
+        frame.Goto(nest_end);
+        frame.final_cycle = true;
+        obj_stack_.Push(); //avoid error
+        return;
+      }
+
+      obj_stack_.Push();
+      obj_stack_.CreateObject(kStrIteratorObj, Object(cursor, kTypeIdForEachCursor));
+      obj_stack_.CreateObject(kStrContainerKeepAliveSlot, container_obj);
+      obj_stack_.CreateObject(unit_id, cursor->Unpack());
+      return;
+    }
+
     if (!type::CheckBehavior(container_obj, kContainerBehavior)) {
       frame.MakeError("Invalid container object");
       return;
@@ -1249,7 +1468,6 @@ namespace kagami {
       frame.Goto(nest_end);
       frame.final_cycle = true;
       obj_stack_.Push(); //avoid error
-      frame.scope_stack.push(false);
       return;
     }
 
@@ -1262,17 +1480,36 @@ namespace kagami {
     auto unit = Invoke(iterator_obj, "obj").GetObj();
     if (frame.error) return;
 
-    frame.scope_stack.push(true);
     obj_stack_.Push();
     obj_stack_.CreateObject(kStrIteratorObj, iterator_obj);
     obj_stack_.CreateObject(kStrContainerKeepAliveSlot, container_obj);
     obj_stack_.CreateObject(unit_id, unit);
   }
 
-  void Machine::ForEachChecking(ArgumentList &args, size_t nest_end) {
+  void Machine::ForEachChecking(ArgumentView &args, size_t nest_end) {
+    static TypeId cursor_type = InternTypeId(kTypeIdForEachCursor);
     auto &frame = frame_stack_.top();
     auto unit_id = FetchObject(args[0]).Cast<string>();
-    auto iterator = *obj_stack_.GetCurrent().Find(kStrIteratorObj);
+    auto &scope = obj_stack_.GetCurrent();
+    //Loop unit is rebound in place, so it doesn't change the scope layout.
+    scope.ResetIteration(kForEachExceptions, unit_id);
+    auto iterator = *scope.Find(kStrIteratorObj);
+
+    if (iterator.GetTypeRecord() == cursor_type) {
+      auto &cursor = iterator.Cast<ForEachCursor>();
+      cursor.StepForward();
+
+      if (cursor.AtEnd(*scope.Find(kStrContainerKeepAliveSlot))) {
+        frame.Goto(nest_end);
+        frame.final_cycle = true;
+      }
+      else {
+        BindForEachUnit(unit_id, cursor.Unpack());
+      }
+
+      return;
+    }
+
     auto container = *obj_stack_.GetCurrent().Find(kStrContainerKeepAliveSlot);
     ObjectMap obj_map;
 
@@ -1302,24 +1539,26 @@ namespace kagami {
     else {
       auto unit = Invoke(iterator, "obj").GetObj();
       if (frame.error) return;
-      obj_stack_.CreateObject(unit_id, unit);
+      BindForEachUnit(unit_id, unit);
     }
   }
 
-  void Machine::CommandCase(ArgumentList &args, size_t nest_end) {
+  void Machine::BindForEachUnit(const string &unit_id, const Object &unit) {
+    auto *dest = obj_stack_.GetCurrent().Find(unit_id, false);
+
+    if (dest != nullptr) *dest = unit;
+    else obj_stack_.CreateObject(unit_id, unit);
+  }
+
+  //Target is the first branch of case block
+  void Machine::CommandCase(ArgumentView &args, size_t target) {
     auto &frame = frame_stack_.top();
-    auto &code = code_stack_.back();
 
     if (args.empty()) {
       frame.MakeError("Empty argument list");
       return;
     }
 
-    frame.AddJumpRecord(nest_end);
-
-    bool has_jump_list = 
-      code->FindJumpRecord(frame.idx + frame.jump_offset, frame.branch_jump_stack);
-
     Object obj = FetchObject(args[0]);
     string type_id = obj.GetTypeId();
 
@@ -1330,61 +1569,26 @@ namespace kagami {
 
     Object sample_obj = type::CreateObjectCopy(obj);
 
-    frame.scope_stack.push(true);
     obj_stack_.Push();
     obj_stack_.CreateObject(kStrCaseObj, sample_obj);
-    frame.condition_stack.push(false);
-
-    if (has_jump_list) {
-      frame.Goto(frame.branch_jump_stack.top());
-      frame.branch_jump_stack.pop();
-    }
-    else {
-      //although I think no one will write case block without condition branch...
-      frame.Goto(frame.jump_stack.top());
-    }
+    frame.Goto(target);
   }
 
-  void Machine::CommandElse() {
+  //Target is next branch of case block
+  void Machine::CommandWhen(ArgumentView &args, size_t target) {
     auto &frame = frame_stack_.top();
 
-    if (frame.condition_stack.empty()) {
-      frame.MakeError("Unexpected 'else'");
-      return;
-    }
-
-    if (frame.condition_stack.top() == true) {
-      frame.Goto(frame.jump_stack.top());
-    }
-    else {
-      frame.condition_stack.top() = true;
-    }
-  }
-
-  void Machine::CommandWhen(ArgumentList &args) {
-    auto &frame = frame_stack_.top();
-    bool result = false;
-
-    if (frame.condition_stack.empty()) {
-      frame.MakeError("Unexpected 'when'");
-      return;
-    }
-
-    if (frame.condition_stack.top()) {
-      frame.Goto(frame.jump_stack.top());
-      return;
-    }
-
     if (!args.empty()) {
       ObjectPointer ptr = obj_stack_.Find(kStrCaseObj);
-      string type_id = ptr->GetTypeId();
       bool found = false;
 
       if (ptr == nullptr) {
-        frame.MakeError("Unexpected 'when'(2)");
+        frame.MakeError("Unexpected 'when'");
         return;
       }
 
+      string type_id = ptr->GetTypeId();
+
       if (!lexical::IsPlainType(type_id)) {
         frame.MakeError("Non-plain object is not supported for now");
         return;
@@ -1414,36 +1618,21 @@ namespace kagami {
       }
 #undef COMPARE_RESULT
 
-      if (found) {
-        frame.condition_stack.top() = true;
-      }
-      else {
-        if (!frame.branch_jump_stack.empty()) {
-          frame.Goto(frame.branch_jump_stack.top());
-          frame.branch_jump_stack.pop();
-        }
-        else {
-          frame.Goto(frame.jump_stack.top());
-        }
-      }
+      if (!found) frame.Goto(target);
     }
   }
 
-  void Machine::CommandContinueOrBreak(Keyword token, size_t escape_depth) {
+  //escape_depth is the count of case scopes between here and the cycle,
+  //target is end of the cycle.
+  void Machine::CommandContinueOrBreak(Keyword token, size_t escape_depth, size_t target) {
     auto &frame = frame_stack_.top();
-    auto &scope_stack = frame.scope_stack;
 
     while (escape_depth != 0) {
-      frame.condition_stack.pop();
-      frame.jump_stack.pop();
-      if (!scope_stack.empty() && scope_stack.top()) {
-        obj_stack_.Pop();
-      }
-      scope_stack.pop();
+      obj_stack_.Pop();
       escape_depth -= 1;
     }
 
-    frame.Goto(frame.jump_stack.top());
+    frame.Goto(target);
 
     switch (token) {
     case kKeywordContinue:
@@ -1457,7 +1646,7 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandStructBegin(ArgumentList &args) {
+  void Machine::CommandStructBegin(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (args.size() < 1) {
@@ -1480,7 +1669,7 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandModuleBegin(ArgumentList &args) {
+  void Machine::CommandModuleBegin(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(1)) {
@@ -1494,14 +1683,6 @@ namespace kagami {
     frame.struct_id = id_obj.Cast<string>();
   }
 
-  void Machine::CommandConditionEnd() {
-    auto &frame = frame_stack_.top();
-    frame.condition_stack.pop();
-    frame.jump_stack.pop();
-    frame.scope_stack.pop();
-    while (!frame.branch_jump_stack.empty()) frame.branch_jump_stack.pop();
-  }
-
   void Machine::CommandLoopEnd(size_t nest) {
     auto &frame = frame_stack_.top();
 
@@ -1509,22 +1690,21 @@ namespace kagami {
       if (frame.activated_continue) {
         frame.Goto(nest);
         frame.activated_continue = false;
-        obj_stack_.GetCurrent().Clear();
+        obj_stack_.GetCurrent().ResetIteration();
         frame.jump_from_end = true;
       }
       else {
         if (frame.activated_break) frame.activated_break = false;
-        while (!frame.return_stack.empty()) frame.return_stack.pop();
-        frame.jump_stack.pop();
+        frame.ClearReturnStack();
         obj_stack_.Pop();
       }
-      frame.scope_stack.pop();
       frame.final_cycle = false;
     }
     else {
       frame.Goto(nest);
-      while (!frame.return_stack.empty()) frame.return_stack.pop();
-      obj_stack_.GetCurrent().Clear();
+      frame.activated_continue = false;
+      frame.ClearReturnStack();
+      obj_stack_.GetCurrent().ResetIteration();
       frame.jump_from_end = true;
     }
   }
@@ -1536,20 +1716,17 @@ namespace kagami {
       if (frame.activated_continue) {
         frame.Goto(nest);
         frame.activated_continue = false;
-        obj_stack_.GetCurrent().ClearExcept(kForEachExceptions);
         frame.jump_from_end = true;
       }
       else {
         if (frame.activated_break) frame.activated_break = false;
-        frame.jump_stack.pop();
         obj_stack_.Pop();
       }
-      if(!frame.scope_stack.empty()) frame.scope_stack.pop();
       frame.final_cycle = false;
     }
     else {
       frame.Goto(nest);
-      obj_stack_.GetCurrent().ClearExcept(kForEachExceptions);
+      frame.activated_continue = false;
       frame.jump_from_end = true;
     }
   }
@@ -1639,7 +1816,7 @@ namespace kagami {
     frame.struct_id.shrink_to_fit();
   }
 
-  void Machine::CommandInclude(ArgumentList &args) {
+  void Machine::CommandInclude(ArgumentView &args) {
     //TODO:insert module id into !module_list
     auto &frame = frame_stack_.top();
     auto &base = obj_stack_.GetCurrent();
@@ -1662,26 +1839,26 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandSuper(ArgumentList &args) {
+  void Machine::CommandSuper(ArgumentView &args) {
     //TODO:call initializer of super struct
     auto &frame = frame_stack_.top();
 
   }
 
-  void Machine::CommandHash(ArgumentList &args) {
+  void Machine::CommandHash(ArgumentView &args) {
     auto &frame = frame_stack_.top();
     auto &obj = FetchObject(args[0]).Unpack();
 
     if (type::IsHashable(obj)) {
       int64_t hash = type::GetHash(obj);
-      frame.RefreshReturnStack(Object(make_shared<int64_t>(hash), kTypeIdInt));
+      frame.RefreshReturnStack(Object(static_cast<int64_t>(hash), kTypeIdInt));
     }
     else {
       frame.RefreshReturnStack(Object());
     }
   }
 
-  void Machine::CommandSwap(ArgumentList &args) {
+  void Machine::CommandSwap(ArgumentView &args) {
     auto &frame = frame_stack_.top();
     auto &right = FetchObject(args[1]).Unpack();
     auto &left = FetchObject(args[0]).Unpack();
@@ -1689,7 +1866,7 @@ namespace kagami {
     left.swap(right);
   }
 
-  void Machine::CommandBind(ArgumentList &args, bool local_value, bool ext_value) {
+  void Machine::CommandBind(ArgumentView &args, bool local_value, bool ext_value) {
     using namespace type;
     auto &frame = frame_stack_.top();
     //Do not change the order!
@@ -1717,7 +1894,7 @@ namespace kagami {
       }
 
       if (!local_value && frame.struct_id.empty()) {
-        ObjectPointer ptr = obj_stack_.Find(id);
+        ObjectPointer ptr = FindObjectBySlot(id, args[0].GetSlot(), args[0].IsLocalSlot());
 
         if (ptr != nullptr) {
           ptr->Unpack() = CreateObjectCopy(rhs);
@@ -1734,7 +1911,7 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandDelivering(ArgumentList &args, bool local_value, bool ext_value) {
+  void Machine::CommandDelivering(ArgumentView &args, bool local_value, bool ext_value) {
     auto &frame = frame_stack_.top();
     //Do not change the order!
     auto rhs = FetchObject(args[1]);
@@ -1754,7 +1931,7 @@ namespace kagami {
       }
 
       if (!local_value && frame.struct_id.empty()) {
-        ObjectPointer ptr = obj_stack_.Find(id);
+        ObjectPointer ptr = FindObjectBySlot(id, args[0].GetSlot(), args[0].IsLocalSlot());
 
         if (ptr != nullptr) {
           ptr->Unpack() = rhs.Unpack();
@@ -1773,7 +1950,7 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandTypeId(ArgumentList &args) {
+  void Machine::CommandTypeId(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (args.size() > 1) {
@@ -1794,7 +1971,7 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandMethods(ArgumentList &args) {
+  void Machine::CommandMethods(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(1)) {
@@ -1823,7 +2000,7 @@ namespace kagami {
     frame.RefreshReturnStack(ret_obj);
   }
 
-  void Machine::CommandExist(ArgumentList &args) {
+  void Machine::CommandExist(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(2)) {
@@ -1841,7 +2018,7 @@ namespace kagami {
     }
 
     string str = str_obj.Cast<string>();
-    bool first_stage = type::CheckMethod(str, obj.GetTypeId());
+    bool first_stage = type::CheckMethod(str, obj.GetTypeRecord());
     bool second_stage = obj.IsSubContainer() ?
       [&]() -> bool {
       auto &container = obj.Cast<ObjectStruct>().GetContent();
@@ -1857,7 +2034,7 @@ namespace kagami {
     frame.RefreshReturnStack(ret_obj);
   }
 
-  void Machine::CommandNullObj(ArgumentList &args) {
+  void Machine::CommandNullObj(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(1)) {
@@ -1869,7 +2046,7 @@ namespace kagami {
     frame.RefreshReturnStack(Object(obj.GetTypeId() == kTypeIdNull, kTypeIdBool));
   }
 
-  void Machine::CommandDestroy(ArgumentList &args) {
+  void Machine::CommandDestroy(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(1)) {
@@ -1881,7 +2058,7 @@ namespace kagami {
     obj.swap(Object());
   }
 
-  void Machine::CommandConvert(ArgumentList &args) {
+  void Machine::CommandConvert(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(1)) {
@@ -1904,13 +2081,13 @@ namespace kagami {
 
         switch (type) {
         case kStringTypeInt:
-          ret_obj.PackContent(make_shared<int64_t>(stol(str)), kTypeIdInt);
+          ret_obj.PackValue(static_cast<int64_t>(stol(str)), kTypeIdInt);
           break;
         case kStringTypeFloat:
-          ret_obj.PackContent(make_shared<double>(stod(str)), kTypeIdFloat);
+          ret_obj.PackValue(stod(str), kTypeIdFloat);
           break;
         case kStringTypeBool:
-          ret_obj.PackContent(make_shared<bool>(str == kStrTrue), kTypeIdBool);
+          ret_obj.PackValue(str == kStrTrue, kTypeIdBool);
           break;
         default:
           ret_obj = obj;
@@ -1931,7 +2108,7 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandUsing(ArgumentList &args) {
+  void Machine::CommandUsing(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(1)) {
@@ -1978,7 +2155,7 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandUsingTable(ArgumentList &args) {
+  void Machine::CommandUsingTable(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(2)) {
@@ -2018,7 +2195,7 @@ namespace kagami {
     frame.RefreshReturnStack(table_obj);
   }
 
-  void Machine::CommandApplyLayout(ArgumentList &args) {
+  void Machine::CommandApplyLayout(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(2)) {
@@ -2045,21 +2222,91 @@ namespace kagami {
     config_proc.ApplyInterfaceLayout(window);
   }
 
-  void Machine::CommandOffensiveMode(ArgumentList &args) {
+  //offensive_mode(value, frame_rate = display refresh rate)
+  void Machine::CommandOffensiveMode(ArgumentView &args) {
     auto &frame = frame_stack_.top();
+    int64_t frame_rate = 0;
 
-    if (!EXPECTED_COUNT(1)) {
-      frame.MakeError("Argument is misssing - offensive_mode(obj, obj)");
+    if (!EXPECTED_COUNT(1) && !EXPECTED_COUNT(2)) {
+      frame.MakeError("Argument is misssing - offensive_mode(value, frame_rate)");
       return;
     }
 
+    //Do not change the order
+    if (args.size() == 2) {
+      auto rate_obj = FetchObject(args[1]);
+
+      if (rate_obj.GetTypeId() != kTypeIdInt || rate_obj.Cast<int64_t>() <= 0) {
+        frame.MakeError("Invalid frame rate");
+        return;
+      }
+
+      frame_rate = rate_obj.Cast<int64_t>();
+    }
+
     auto value_obj = FetchObject(args[0]);
 
     if (value_obj.GetTypeId() != kTypeIdBool) {
       frame.MakeError("Invalid boolean value");
+      return;
     }
 
-    offensive_ = value_obj.Cast<bool>();
+    bool value = value_obj.Cast<bool>();
+
+    if (offensive_ && !value) redraw_.Flush();
+    if (value) redraw_.Start(frame_rate);
+
+    offensive_ = value;
+  }
+
+  void Machine::CommandFrameStats() {
+    auto &frame = frame_stack_.top();
+    frame.RefreshReturnStack(redraw_.GetStatistics());
+  }
+
+  //event_polling(instructions, microseconds)
+  void Machine::CommandEventPolling(ArgumentView &args) {
+    auto &frame = frame_stack_.top();
+
+    if (!EXPECTED_COUNT(2)) {
+      frame.MakeError("Argument is missing - event_polling(instructions, microseconds)");
+      return;
+    }
+
+    //Do not change the order
+    auto period_obj = FetchObject(args[1]);
+    auto interval_obj = FetchObject(args[0]);
+
+    if (interval_obj.GetTypeId() != kTypeIdInt || period_obj.GetTypeId() != kTypeIdInt) {
+      frame.MakeError("Invalid polling budget");
+      return;
+    }
+
+    auto interval = interval_obj.Cast<int64_t>();
+    auto period = period_obj.Cast<int64_t>();
+
+    if (interval < 1 || period < 0) {
+      frame.MakeError("Invalid polling budget");
+      return;
+    }
+
+    poll_interval_ = static_cast<size_t>(interval);
+    poll_countdown_ = poll_interval_;
+    poll_period_ = std::chrono::microseconds(period);
+  }
+
+  //Pending events are kept in SDL queue, so they don't need to be fetched
+  //on every instruction. Clock is read only when instruction budget runs out.
+  bool Machine::IsEventPollingDue() {
+    if (--poll_countdown_ > 0) return false;
+
+    poll_countdown_ = poll_interval_;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_poll_ < poll_period_) return false;
+
+    last_poll_ = now;
+    return true;
   }
 
   void Machine::CommandTime() {
@@ -2081,7 +2328,7 @@ namespace kagami {
   }
 
   template <Keyword op_code>
-  void Machine::BinaryMathOperatorImpl(ArgumentList &args) {
+  void Machine::BinaryMathOperatorImpl(Instruction &inst, ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(2)) {
@@ -2091,16 +2338,43 @@ namespace kagami {
 
     auto rhs = FetchObject(args[1]);
     auto lhs = FetchObject(args[0]);
-    auto type_rhs = FindTypeCode(rhs.GetTypeId());
-    auto type_lhs = FindTypeCode(lhs.GetTypeId());
 
     if (frame.error) return;
 
+#define QUICKENED_PROCESSING(_Type, _TypeId)                   \
+  frame.RefreshReturnStack(Object(                             \
+    MathBox<_Type, op_code>().Do(lhs.Cast<_Type>(), rhs.Cast<_Type>()), _TypeId));
+
+    if (inst.spec != kSpecializeNone && inst.spec != kSpecializeGeneric) {
+      if (MatchSpecialization(inst.spec, lhs, rhs)) {
+        switch (inst.spec) {
+        case kSpecializeInt:
+          QUICKENED_PROCESSING(int64_t, GetInlineTypeId(kInlineInt)); break;
+        case kSpecializeFloat:
+          QUICKENED_PROCESSING(double, GetInlineTypeId(kInlineFloat)); break;
+        default:
+          QUICKENED_PROCESSING(string, GetStringTypeId()); break;
+        }
+
+        return;
+      }
+
+      inst.spec = kSpecializeGeneric;
+    }
+#undef QUICKENED_PROCESSING
+
+    auto type_rhs = FindTypeCode(rhs.GetTypeRecord());
+    auto type_lhs = FindTypeCode(lhs.GetTypeRecord());
+
     if (type_lhs == kNotPlainType || type_rhs == kNotPlainType) {
       frame.MakeError("Try to operate with non-plain type.");
       return;
     }
 
+    if (inst.spec == kSpecializeNone) {
+      inst.spec = SpecializeOperands(type_lhs, type_rhs, op_code);
+    }
+
     auto result_type = kResultDynamicTraits.at(ResultTraitKey(type_lhs, type_rhs));
 
 #define RESULT_PROCESSING(_Type, _Func, _TypeId)                       \
@@ -2113,22 +2387,22 @@ namespace kagami {
         return;
       }
 
-      RESULT_PROCESSING(string, StringProducer, kTypeIdString);
+      RESULT_PROCESSING(string, StringProducer, GetStringTypeId());
     }
     else if (result_type == kPlainInt) {
-      RESULT_PROCESSING(int64_t, IntProducer, kTypeIdInt);
+      RESULT_PROCESSING(int64_t, IntProducer, GetInlineTypeId(kInlineInt));
     }
     else if (result_type == kPlainFloat) {
-      RESULT_PROCESSING(double, FloatProducer, kTypeIdFloat);
+      RESULT_PROCESSING(double, FloatProducer, GetInlineTypeId(kInlineFloat));
     }
     else if (result_type == kPlainBool) {
-      RESULT_PROCESSING(bool, BoolProducer, kTypeIdBool);
+      RESULT_PROCESSING(bool, BoolProducer, GetInlineTypeId(kInlineBool));
     }
 #undef RESULT_PROCESSING
   }
 
   template <Keyword op_code>
-  void Machine::BinaryLogicOperatorImpl(ArgumentList &args) {
+  void Machine::BinaryLogicOperatorImpl(Instruction &inst, ArgumentView &args) {
     using namespace type;
     auto &frame = frame_stack_.top();
 
@@ -2139,19 +2413,39 @@ namespace kagami {
 
     auto rhs = FetchObject(args[1]);
     auto lhs = FetchObject(args[0]);
-    auto type_rhs = FindTypeCode(rhs.GetTypeId());
-    auto type_lhs = FindTypeCode(lhs.GetTypeId());
     bool result = false;
 
     if (frame.error) return;
 
+#define QUICKENED_PROCESSING(_Type)                                         \
+  result = LogicBox<_Type, op_code>().Do(lhs.Cast<_Type>(), rhs.Cast<_Type>());
+
+    if (inst.spec != kSpecializeNone && inst.spec != kSpecializeGeneric) {
+      if (MatchSpecialization(inst.spec, lhs, rhs)) {
+        switch (inst.spec) {
+        case kSpecializeInt: QUICKENED_PROCESSING(int64_t); break;
+        case kSpecializeFloat: QUICKENED_PROCESSING(double); break;
+        default: QUICKENED_PROCESSING(string); break;
+        }
+
+        frame.RefreshReturnStack(Object(result, GetInlineTypeId(kInlineBool)));
+        return;
+      }
+
+      inst.spec = kSpecializeGeneric;
+    }
+#undef QUICKENED_PROCESSING
+
+    auto type_rhs = FindTypeCode(rhs.GetTypeRecord());
+    auto type_lhs = FindTypeCode(lhs.GetTypeRecord());
+
     if (!lexical::IsPlainType(lhs.GetTypeId())) {
       if (op_code != kKeywordEquals && op_code != kKeywordNotEqual) {
         frame.RefreshReturnStack();
         return;
       }
 
-      if (!CheckMethod(kStrCompare, lhs.GetTypeId())) {
+      if (!CheckMethod(kStrCompare, lhs.GetTypeRecord())) {
         frame.MakeError("Can't operate with this operator.");
         return;
       }
@@ -2175,6 +2469,10 @@ namespace kagami {
       return;
     }
 
+    if (inst.spec == kSpecializeNone) {
+      inst.spec = SpecializeOperands(type_lhs, type_rhs, op_code);
+    }
+
     auto result_type = kResultDynamicTraits.at(ResultTraitKey(type_lhs, type_rhs));
 #define RESULT_PROCESSING(_Type, _Func)\
   result = LogicBox<_Type, op_code>().Do(_Func(lhs), _Func(rhs));
@@ -2197,11 +2495,11 @@ namespace kagami {
       RESULT_PROCESSING(bool, BoolProducer);
     }
 
-    frame.RefreshReturnStack(Object(result, kTypeIdBool));
+    frame.RefreshReturnStack(Object(result, GetInlineTypeId(kInlineBool)));
 #undef RESULT_PROCESSING
   }
 
-  void Machine::OperatorLogicNot(ArgumentList &args) {
+  void Machine::OperatorLogicNot(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(1)) {
@@ -2218,18 +2516,46 @@ namespace kagami {
 
     bool result = !rhs.Cast<bool>();
 
-    frame.RefreshReturnStack(Object(result, kTypeIdBool));
+    frame.RefreshReturnStack(Object(result, GetInlineTypeId(kInlineBool)));
   }
 
 
-  void Machine::ExpList(ArgumentList &args) {
+  //Skip right operand of logic operator if left one decides the result.
+  //Only bool value is taken, other types are left to the operator.
+  void Machine::LogicShortCircuit(Instruction &inst, ArgumentView &args) {
+    auto &frame = frame_stack_.top();
+    auto &code = *code_stack_.back();
+    auto lhs = FetchObject(args[0], true);
+
+    if (frame.error) return;
+    if (lhs.GetTypeRecord() != GetInlineTypeId(kInlineBool)) return;
+
+    size_t op_idx = frame.idx + inst.option.skip_distance;
+    auto &op = code.GetInstruction(op_idx);
+    bool value = lhs.Cast<bool>();
+
+    if (op.keyword == kKeywordAnd ? value : !value) return;
+
+    if (args[0].GetType() == kArgumentReturnStack) {
+      frame.PopReturnStack();
+    }
+
+    if (!op.option.void_call) {
+      frame.RefreshReturnStack(Object(value, GetInlineTypeId(kInlineBool)));
+    }
+
+    frame.idx = op_idx + 1;
+    frame.disable_step = true;
+  }
+
+  void Machine::ExpList(ArgumentView &args) {
     auto &frame = frame_stack_.top();
     if (!args.empty()) {
       frame.RefreshReturnStack(FetchObject(args.back()));
     }
   }
 
-  void Machine::InitArray(ArgumentList &args) {
+  void Machine::InitArray(ArgumentView &args) {
     auto &frame = frame_stack_.top();
     ManagedArray base = make_shared<ObjectArray>();
 
@@ -2243,7 +2569,7 @@ namespace kagami {
     frame.RefreshReturnStack(obj);
   }
 
-  void Machine::CommandReturn(ArgumentList &args) {
+  void Machine::CommandReturn(ArgumentView &args) {
     if (frame_stack_.size() == 1) {
       frame_stack_.top().MakeError("Unexpected return");
       return;
@@ -2297,7 +2623,7 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandAssert(ArgumentList &args) {
+  void Machine::CommandAssert(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(1)) {
@@ -2317,7 +2643,7 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandHandle(ArgumentList &args) {
+  void Machine::CommandHandle(ArgumentView &args) {
     auto &frame = frame_stack_.top();
 
     if (!EXPECTED_COUNT(3)) {
@@ -2346,138 +2672,244 @@ namespace kagami {
     }
   }
 
-  void Machine::CommandWait(ArgumentList &args) {
+  void Machine::CommandWait(ArgumentView &args) {
     hanging_ = true;
   }
 
-  void Machine::CommandLeave(ArgumentList &args) {
+  void Machine::CommandLeave(ArgumentView &args) {
     hanging_ = false;
   }
 
-  void Machine::DomainAssert(ArgumentList &args) {
+  void Machine::DomainAssert(ArgumentView &args) {
     auto &frame = frame_stack_.top();
-    frame.assert_rc_copy = FetchObject(args[0]).Unpack();
+    auto obj = FetchObject(args[0]);
+
+    //Reference to variable or member is kept as is, so following member
+    //access and method calling work on the object itself instead of a copy.
+    type::DetachSharedContent(obj);
+    frame.assert_rc_copy = obj;
   }
 
-  void Machine::MachineCommands(Keyword token, ArgumentList &args, Request &request) {
+#ifdef THREADED_DISPATCH
+#define DISPATCH_CASE(_Keyword) _Keyword##_Handler:
+#define DISPATCH_DEFAULT kKeywordNull_Handler:
+#define DISPATCH_NEXT                               \
+  if (!FetchNextCommand(inst, args)) return;        \
+  goto *kDispatchTable[inst->keyword]
+#else
+#define DISPATCH_CASE(_Keyword) case _Keyword:
+#define DISPATCH_DEFAULT default:
+#define DISPATCH_NEXT break
+#endif
+
+  //Load next instruction for threaded dispatching. Main loop will take over
+  //if next one is not a built-in command or per-tick jobs are required.
+  bool Machine::FetchNextCommand(InstructionPointer &inst, ArgumentView &args) {
     auto &frame = frame_stack_.top();
+    auto &code = *code_stack_.back();
+    size_t next = frame.disable_step ? frame.idx : frame.idx + 1;
+
+    if (frame.error || frame.warning || hanging_ || offensive_) return false;
+    if (inst->keyword == kKeywordReturn) return false;
+    if (next >= frame.code_end) return false;
+    if (code.GetInstruction(next).type != kRequestCommand) return false;
+
+    frame.Stepping();
+    inst = &code.GetInstruction(frame.idx);
+    args = code.GetArguments(*inst);
+    frame.void_call = inst->option.void_call;
+    return true;
+  }
 
-    switch (token) {
-    case kKeywordPlus:
-      BinaryMathOperatorImpl<kKeywordPlus>(args);
-      break;
-    case kKeywordMinus:
-      BinaryMathOperatorImpl<kKeywordMinus>(args);
-      break;
-    case kKeywordTimes:
-      BinaryMathOperatorImpl<kKeywordTimes>(args);
-      break;
-    case kKeywordDivide:
-      BinaryMathOperatorImpl<kKeywordDivide>(args);
-      break;
-    case kKeywordEquals:
-      BinaryLogicOperatorImpl<kKeywordEquals>(args);
-      break;
-    case kKeywordLessOrEqual:
-      BinaryLogicOperatorImpl<kKeywordLessOrEqual>(args);
-      break;
-    case kKeywordGreaterOrEqual:
-      BinaryLogicOperatorImpl<kKeywordGreaterOrEqual>(args);
-      break;
-    case kKeywordNotEqual:
-      BinaryLogicOperatorImpl<kKeywordNotEqual>(args);
-      break;
-    case kKeywordGreater:
-      BinaryLogicOperatorImpl<kKeywordGreater>(args);
-      break;
-    case kKeywordLess:
-      BinaryLogicOperatorImpl<kKeywordLess>(args);
-      break;
-    case kKeywordAnd:
-      BinaryLogicOperatorImpl<kKeywordAnd>(args);
-      break;
-    case kKeywordOr:
-      BinaryLogicOperatorImpl<kKeywordOr>(args);
-      break;
-    case kKeywordNot:
+  void Machine::MachineCommands(InstructionPointer &inst, ArgumentView &args) {
+#ifdef THREADED_DISPATCH
+    //Handler table must follow the order of Keyword
+    static void *const kDispatchTable[] = {
+      &&kKeywordAssert_Handler,
+      &&kKeywordNull_Handler,
+      &&kKeywordNull_Handler,
+      &&kKeywordHash_Handler,
+      &&kKeywordFor_Handler,
+      &&kKeywordNull_Handler,
+      &&kKeywordNullObj_Handler,
+      &&kKeywordDestroy_Handler,
+      &&kKeywordConvert_Handler,
+      &&kKeywordTime_Handler,
+      &&kKeywordVersion_Handler,
+      &&kKeywordCodeName_Handler,
+      &&kKeywordSwap_Handler,
+      &&kKeywordExpList_Handler,
+      &&kKeywordFn_Handler,
+      &&kKeywordIf_Handler,
+      &&kKeywordElif_Handler,
+      &&kKeywordEnd_Handler,
+      &&kKeywordElse_Handler,
+      &&kKeywordBind_Handler,
+      &&kKeywordDelivering_Handler,
+      &&kKeywordWhile_Handler,
+      &&kKeywordPlus_Handler,
+      &&kKeywordMinus_Handler,
+      &&kKeywordTimes_Handler,
+      &&kKeywordDivide_Handler,
+      &&kKeywordEquals_Handler,
+      &&kKeywordLessOrEqual_Handler,
+      &&kKeywordGreaterOrEqual_Handler,
+      &&kKeywordNotEqual_Handler,
+      &&kKeywordGreater_Handler,
+      &&kKeywordLess_Handler,
+      &&kKeywordReturn_Handler,
+      &&kKeywordAnd_Handler,
+      &&kKeywordOr_Handler,
+      &&kKeywordNot_Handler,
+      &&kKeywordInitialArray_Handler,
+      &&kKeywordContinue_Handler,
+      &&kKeywordBreak_Handler,
+      &&kKeywordCase_Handler,
+      &&kKeywordWhen_Handler,
+      &&kKeywordTypeId_Handler,
+      &&kKeywordExist_Handler,
+      &&kKeywordMethods_Handler,
+      &&kKeywordNull_Handler,
+      &&kKeywordHandle_Handler,
+      &&kKeywordWait_Handler,
+      &&kKeywordLeave_Handler,
+      &&kKeywordUsing_Handler,
+      &&kKeywordUsingTable_Handler,
+      &&kKeywordApplyLayout_Handler,
+      &&kKeywordOffensiveMode_Handler,
+      &&kKeywordEventPolling_Handler,
+      &&kKeywordFrameStats_Handler,
+      &&kKeywordStruct_Handler,
+      &&kKeywordModule_Handler,
+      &&kKeywordDomainAssertCommand_Handler,
+      &&kKeywordInclude_Handler,
+      &&kKeywordNull_Handler,
+      &&kKeywordShortCircuit_Handler,
+      &&kKeywordJump_Handler,
+      &&kKeywordNull_Handler
+    };
+
+    static_assert(sizeof(kDispatchTable) / sizeof(void *) == kKeywordNull + 1,
+      "Dispatch table is not matched with Keyword");
+
+    goto *kDispatchTable[inst->keyword];
+#else
+    switch (inst->keyword) {
+#endif
+    DISPATCH_CASE(kKeywordPlus)
+      BinaryMathOperatorImpl<kKeywordPlus>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordMinus)
+      BinaryMathOperatorImpl<kKeywordMinus>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordTimes)
+      BinaryMathOperatorImpl<kKeywordTimes>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordDivide)
+      BinaryMathOperatorImpl<kKeywordDivide>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordEquals)
+      BinaryLogicOperatorImpl<kKeywordEquals>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordLessOrEqual)
+      BinaryLogicOperatorImpl<kKeywordLessOrEqual>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordGreaterOrEqual)
+      BinaryLogicOperatorImpl<kKeywordGreaterOrEqual>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordNotEqual)
+      BinaryLogicOperatorImpl<kKeywordNotEqual>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordGreater)
+      BinaryLogicOperatorImpl<kKeywordGreater>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordLess)
+      BinaryLogicOperatorImpl<kKeywordLess>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordAnd)
+      BinaryLogicOperatorImpl<kKeywordAnd>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordOr)
+      BinaryLogicOperatorImpl<kKeywordOr>(*inst, args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordNot)
       OperatorLogicNot(args);
-      break;
-    case kKeywordHash:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordHash)
       CommandHash(args);
-      break;
-    case kKeywordFor:
-      CommandForEach(args, request.option.nest_end);
-      break;
-    case kKeywordNullObj:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordFor)
+      CommandForEach(args, inst->option.nest_end);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordNullObj)
       CommandNullObj(args);
-      break;
-    case kKeywordDestroy:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordDestroy)
       CommandDestroy(args);
-      break;
-    case kKeywordConvert:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordConvert)
       CommandConvert(args);
-      break;
-    case kKeywordTime:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordTime)
       CommandTime();
-      break;
-    case kKeywordVersion:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordVersion)
       CommandVersion();
-      break;
-    case kKeywordCodeName:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordCodeName)
       CommandMachineCodeName();
-      break;
-    case kKeywordSwap:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordSwap)
       CommandSwap(args);
-      break;
-    case kKeywordBind:
-      CommandBind(args, request.option.local_object,
-        request.option.ext_object);
-      break;
-    case kKeywordDelivering:
-      CommandDelivering(args, request.option.local_object,
-        request.option.ext_object);
-      break;
-    case kKeywordExpList:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordBind)
+      CommandBind(args, inst->option.local_object,
+        inst->option.ext_object);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordDelivering)
+      CommandDelivering(args, inst->option.local_object,
+        inst->option.ext_object);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordExpList)
       ExpList(args);
-      break;
-    case kKeywordInitialArray:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordInitialArray)
       InitArray(args);
-      break;
-    case kKeywordReturn:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordReturn)
       CommandReturn(args);
-      break;
-    case kKeywordAssert:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordAssert)
       CommandAssert(args);
-      break;
-    case kKeywordTypeId:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordTypeId)
       CommandTypeId(args);
-      break;
-    case kKeywordMethods:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordMethods)
       CommandMethods(args);
-      break;
-    case kKeywordExist:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordExist)
       CommandExist(args);
-      break;
-    case kKeywordFn:
-      ClosureCatching(args, request.option.nest_end, frame_stack_.size() > 1);
-      break;
-    case kKeywordCase:
-      CommandCase(args, request.option.nest_end);
-      break;
-    case kKeywordWhen:
-      CommandWhen(args);
-      break;
-    case kKeywordEnd:
-      switch (request.option.nest_root) {
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordFn)
+      ClosureCatching(args, inst->option, frame_stack_.size() > 1);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordCase)
+      CommandCase(args, inst->option.jump_target);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordWhen)
+      CommandWhen(args, inst->option.jump_target);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordEnd)
+      switch (inst->option.nest_root) {
       case kKeywordWhile:
-        CommandLoopEnd(request.option.nest);
+        CommandLoopEnd(inst->option.nest);
         break;
       case kKeywordFor:
-        CommandForEachEnd(request.option.nest);
+        CommandForEachEnd(inst->option.nest);
         break;
-      case kKeywordIf:
       case kKeywordCase:
-        CommandConditionEnd();
+        obj_stack_.Pop();
         break;
       case kKeywordStruct:
         CommandStructEnd();
@@ -2487,59 +2919,76 @@ namespace kagami {
         break;
       default:break;
       }
-      break;
-    case kKeywordContinue:
-    case kKeywordBreak:
-      CommandContinueOrBreak(token, request.option.escape_depth);
-      break;
-    case kKeywordElse:
-      CommandElse();
-      break;
-    case kKeywordIf:
-    case kKeywordElif:
-    case kKeywordWhile:
-      CommandIfOrWhile(token, args, request.option.nest_end);
-      break;
-    case kKeywordHandle:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordContinue)
+    DISPATCH_CASE(kKeywordBreak)
+      CommandContinueOrBreak(inst->keyword, inst->option.escape_depth,
+        inst->option.jump_target);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordElse)
+      //Nothing to do, previous branch jumps here only if it's failed.
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordJump)
+      frame_stack_.top().Goto(inst->option.jump_target);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordIf)
+    DISPATCH_CASE(kKeywordElif)
+      CommandIfOrWhile(inst->keyword, args, inst->option.jump_target);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordWhile)
+      CommandIfOrWhile(inst->keyword, args, inst->option.nest_end);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordHandle)
       CommandHandle(args);
-      break;
-    case kKeywordWait:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordWait)
       CommandWait(args);
-      break;
-    case kKeywordLeave:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordLeave)
       CommandLeave(args);
-      break;
-    case kKeywordUsing:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordUsing)
       CommandUsing(args);
-      break;
-    case kKeywordUsingTable:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordUsingTable)
       CommandUsingTable(args);
-      break;
-    case kKeywordApplyLayout:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordApplyLayout)
       CommandApplyLayout(args);
-      break;
-    case kKeywordOffensiveMode:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordOffensiveMode)
       CommandOffensiveMode(args);
-      break;
-    case kKeywordStruct:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordEventPolling)
+      CommandEventPolling(args);
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordFrameStats)
+      CommandFrameStats();
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordStruct)
       CommandStructBegin(args);
-      break;
-    case kKeywordModule:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordModule)
       CommandModuleBegin(args);
-      break;
-    case kKeywordDomainAssertCommand:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordDomainAssertCommand)
       DomainAssert(args);
-      break;
-    case kKeywordInclude:
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordInclude)
       CommandInclude(args);
-      break;
+      DISPATCH_NEXT;
+    DISPATCH_CASE(kKeywordShortCircuit)
+      LogicShortCircuit(*inst, args);
+      DISPATCH_NEXT;
       //Super
-    default:
-      break;
+    DISPATCH_DEFAULT
+      DISPATCH_NEXT;
+#ifndef THREADED_DISPATCH
     }
+#endif
   }
 
-  void Machine::GenerateArgs(FunctionImpl &impl, ArgumentList &args, ObjectMap &obj_map) {
+  void Machine::GenerateArgs(FunctionImpl &impl, ArgumentView &args, ObjectMap &obj_map) {
     switch (impl.GetPattern()) {
     case kParamFixed:
       Generate_Fixed(impl, args, obj_map);
@@ -2555,7 +3004,7 @@ namespace kagami {
     }
   }
 
-  void Machine::Generate_Fixed(FunctionImpl &impl, ArgumentList &args, ObjectMap &obj_map) {
+  void Machine::Generate_Fixed(FunctionImpl &impl, ArgumentView &args, ObjectMap &obj_map) {
     auto &frame = frame_stack_.top();
     auto &params = impl.GetParameters();
     size_t pos = args.size() - 1;
@@ -2577,9 +3026,9 @@ namespace kagami {
     }
   }
 
-  void Machine::Generate_AutoSize(FunctionImpl &impl, ArgumentList &args, ObjectMap &obj_map) {
+  void Machine::Generate_AutoSize(FunctionImpl &impl, ArgumentView &args, ObjectMap &obj_map) {
     auto &frame = frame_stack_.top();
-    vector<string> &params = impl.GetParameters();
+    auto &params = impl.GetParameters();
     list<Object> temp_list;
     ManagedArray va_base = make_shared<ObjectArray>();
     size_t pos = args.size(), diff = args.size() - params.size() + 1;
@@ -2612,7 +3061,7 @@ namespace kagami {
     }
   }
 
-  void Machine::Generate_AutoFill(FunctionImpl &impl, ArgumentList &args, ObjectMap &obj_map) {
+  void Machine::Generate_AutoFill(FunctionImpl &impl, ArgumentView &args, ObjectMap &obj_map) {
     auto &frame = frame_stack_.top();
     auto &params = impl.GetParameters();
     size_t limit = impl.GetLimit();
@@ -2640,6 +3089,66 @@ namespace kagami {
     }
   }
 
+  //Arguments are fetched from the last one, as Generate_* does.
+  void Machine::GeneratePositionalArgs(FunctionImpl &impl, ArgumentView &args,
+    vector<Object> &dest) {
+    auto &frame = frame_stack_.top();
+    auto &params = impl.GetParameters();
+    size_t pos = args.size(), fixed_count = params.size();
+
+    dest.clear();
+    dest.resize(params.size());
+
+    switch (impl.GetPattern()) {
+    case kParamFixed:
+      if (args.size() > params.size()) {
+        frame.MakeError("Too many arguments");
+        return;
+      }
+
+      if (args.size() < params.size()) {
+        frame.MakeError("Minimum argument amount is " + to_string(params.size()));
+        return;
+      }
+      break;
+    case kParamAutoFill:
+      if (args.size() > params.size()) {
+        frame.MakeError("Too many arguments");
+        return;
+      }
+
+      if (args.size() < impl.GetLimit()) {
+        frame.MakeError("Minimum argument amount is " + to_string(impl.GetLimit()));
+        return;
+      }
+      break;
+    case kParamAutoSize: {
+      if (args.size() < params.size()) {
+        frame.MakeError("Minimum argument amount is " + to_string(params.size()));
+        return;
+      }
+
+      fixed_count = params.size() - 1;
+      ManagedArray va_base = make_shared<ObjectArray>(args.size() - fixed_count);
+
+      while (pos > fixed_count) {
+        (*va_base)[pos - fixed_count - 1] = FetchObject(args[pos - 1]).RemoveDeliveringFlag();
+        pos -= 1;
+      }
+
+      dest.back() = Object(va_base, kTypeIdArray);
+      break;
+    }
+    default:
+      break;
+    }
+
+    while (pos > 0) {
+      dest[pos - 1] = FetchObject(args[pos - 1]).RemoveDeliveringFlag();
+      pos -= 1;
+    }
+  }
+
   void Machine::LoadEventInfo(SDL_Event &event, ObjectMap &obj_map, FunctionImpl &impl, Uint32 id) {
     auto &frame = frame_stack_.top();
     auto window = dynamic_cast<dawn::PlainWindow *>(dawn::GetWindowById(id));
@@ -2747,10 +3256,9 @@ namespace kagami {
     frame.MakeError(msg);
   }
 
-  void Machine::Run(bool invoking, string id, VMCodePointer ptr, ObjectMap *p,
-    ObjectMap *closure_record) {
+  void Machine::Run(bool invoking, string id, FunctionImplPointer func, ObjectMap *p) {
     if (code_stack_.empty()) return;
-    if (invoking) code_stack_.push_back(ptr);
+    if (invoking) code_stack_.push_back(&func->GetCode());
 
     bool interface_error = false;
     bool invoking_error = false;
@@ -2758,29 +3266,38 @@ namespace kagami {
     size_t script_idx = 0;
     Message msg;
     VMCode *code = code_stack_.back();
-    Command *command = nullptr;
+    Instruction *inst = nullptr;
+    ArgumentView args;
     FunctionImplPointer impl;
     ObjectMap obj_map;
+    Object me;
+    vector<Object> positional_args;
+    string signature_error;
     SDL_Event event;
 
-    frame_stack_.push(RuntimeFrame());
+    frame_stack_.push(operand_stack_);
     obj_stack_.Push();
 
     if (invoking) {
       obj_stack_.CreateObject(kStrUserFunc, Object(id));
       obj_stack_.MergeMap(*p);
-      obj_stack_.MergeMap(*closure_record);
+      obj_stack_.MergeClosureRecord(func->GetClosureRecord());
+      frame_stack_.top().closure_record = func->GetManagedClosureRecord();
       frame_stack_.top().function_scope = id;
+      frame_stack_.top().SetCodeRange(func->GetCodeBegin(), func->GetCodeEnd());
+    }
+    else {
+      frame_stack_.top().SetCodeRange(0, code->GetInstructionCount());
     }
 
     RuntimeFrame *frame = &frame_stack_.top();
-    size_t size = code->size();
+    size_t size = frame->code_end;
 
     //Refreshing loop tick state to make it work correctly.
     auto refresh_tick = [&]() -> void {
       code = code_stack_.back();
-      size = code->size();
       frame = &frame_stack_.top();
+      size = frame->code_end;
     };
 
     //Protect current runtime environment and load another function
@@ -2790,13 +3307,16 @@ namespace kagami {
       bool inside_initializer_calling = frame->initializer_calling;
       frame->initializer_calling = false;
       code_stack_.push_back(&func.GetCode());
-      frame_stack_.push(RuntimeFrame(func.GetId()));
+      frame_stack_.push(operand_stack_);
       obj_stack_.Push();
       obj_stack_.CreateObject(kStrUserFunc, Object(func.GetId()));
       obj_stack_.MergeMap(obj_map);
-      obj_stack_.MergeMap(impl->GetClosureRecord());
+      obj_stack_.MergeClosureRecord(func.GetClosureRecord());
+      //arguments are held by new scope now
+      obj_map.clear();
+      frame_stack_.top().SetCodeRange(func.GetCodeBegin(), func.GetCodeEnd());
+      frame_stack_.top().closure_record = func.GetManagedClosureRecord();
       refresh_tick();
-      frame->jump_offset = func.GetOffset();
       frame->event_processing = event_processing;
       frame->inside_initializer_calling = inside_initializer_calling;
     };
@@ -2805,31 +3325,40 @@ namespace kagami {
     auto tail_recursion = [&]() -> void {
       bool event_processing = frame->event_processing;
       string function_scope = frame_stack_.top().function_scope;
-      size_t jump_offset = frame_stack_.top().jump_offset;
       obj_map.Naturalize(obj_stack_.GetCurrent());
-      frame_stack_.top() = RuntimeFrame(function_scope);
+      frame_stack_.top().ClearReturnStack();
+      frame_stack_.top().Reset(operand_stack_);
+      frame_stack_.top().function_scope = function_scope;
       obj_stack_.ClearCurrent();
       obj_stack_.CreateObject(kStrUserFunc, Object(function_scope));
       obj_stack_.MergeMap(obj_map);
-      obj_stack_.MergeMap(impl->GetClosureRecord());
+      obj_stack_.MergeClosureRecord(impl->GetClosureRecord());
+      //arguments are held by new scope now
+      obj_map.clear();
+      frame_stack_.top().SetCodeRange(impl->GetCodeBegin(), impl->GetCodeEnd());
+      frame_stack_.top().closure_record = impl->GetManagedClosureRecord();
       refresh_tick();
-      frame->jump_offset = jump_offset;
       frame->event_processing = event_processing;
     };
 
     //Convert current environment to next calling
-    auto tail_call = [&](FunctionImpl &func) -> void {
+    //Callee may be held by the scope being cleared, so it's copied
+    auto tail_call = [&](FunctionImpl func) -> void {
       bool event_processing = frame->event_processing;
       code_stack_.pop_back();
       code_stack_.push_back(&func.GetCode());
       obj_map.Naturalize(obj_stack_.GetCurrent());
-      frame_stack_.top() = RuntimeFrame(func.GetId());
+      frame_stack_.top().ClearReturnStack();
+      frame_stack_.top().Reset(operand_stack_);
       obj_stack_.ClearCurrent();
       obj_stack_.CreateObject(kStrUserFunc, Object(func.GetId()));
       obj_stack_.MergeMap(obj_map);
-      obj_stack_.MergeMap(impl->GetClosureRecord());
+      obj_stack_.MergeClosureRecord(func.GetClosureRecord());
+      //arguments are held by new scope now
+      obj_map.clear();
+      frame_stack_.top().SetCodeRange(func.GetCodeBegin(), func.GetCodeEnd());
+      frame_stack_.top().closure_record = func.GetManagedClosureRecord();
       refresh_tick();
-      frame->jump_offset = func.GetOffset();
       frame->event_processing = event_processing;
     };
 
@@ -2850,35 +3379,52 @@ namespace kagami {
       }
 
       //Draw all windows
-      if (offensive_) dawn::ForceRefreshingAllWindow();
+      if (offensive_ && !freezing_) redraw_.Tick();
 
       //window event handler
       //cannot invoke new event inside a running event function
-      if ((hanging_ && !frame->event_processing && SDL_PollEvent(&event) != 0) 
-        || (freezing_ && SDL_WaitEvent(&event) != 0)) {
-        EventHandlerMark mark(event.window.windowID, event.type);
-        auto it = event_list_.find(mark);
-        if (it != event_list_.end()) {
-          obj_map.clear();
-          LoadEventInfo(event, obj_map, it->second, event.window.windowID);
-
-          if (frame->error) break;
-
-          update_stack_frame(it->second);
-          refresh_tick();
-          frame->event_processing = true;
-          continue;
+      auto handler = event_list_.end();
+
+      if (hanging_ && !frame->event_processing && IsEventPollingDue()) {
+        //events without handler are dropped at once
+        while (handler == event_list_.end() && SDL_PollEvent(&event) != 0) {
+          handler = event_list_.find(EventHandlerMark(event.window.windowID, event.type));
         }
+      }
+
+      if (handler == event_list_.end() && freezing_) {
+        if (offensive_) redraw_.Flush();
+
+        if (SDL_WaitEvent(&event) != 0) {
+          handler = event_list_.find(EventHandlerMark(event.window.windowID, event.type));
+        }
+      }
+
+      if (handler != event_list_.end()) {
+        obj_map.clear();
+        LoadEventInfo(event, obj_map, handler->second, event.window.windowID);
+
+        if (frame->error) break;
 
-        if (freezing_) continue;
+        update_stack_frame(handler->second);
+        refresh_tick();
+        frame->event_processing = true;
+        continue;
       }
 
+      if (freezing_) continue;
+
       //switch to last stack frame when indicator reaches end of the block.
       //return expression will be processed in Machine::CommandReturn
       if (frame->idx == size && frame_stack_.size() > 1) {
         //Bring saved environment back
-        if (frame->inside_initializer_calling) FinishInitalizerCalling();
-        else RecoverLastState();
+        if (frame->inside_initializer_calling) {
+          FinishInitalizerCalling();
+        }
+        else {
+          RecoverLastState();
+          frame_stack_.top().RefreshReturnStack();
+        }
         //Update register data
         refresh_tick();
         if (!freezing_) {
@@ -2887,20 +3433,21 @@ namespace kagami {
         continue;
       }
 
-      //load current command and refreshing indicators
-      command = &(*code)[frame->idx];
-      script_idx = command->first.idx;
+      //load current instruction and refreshing indicators
+      inst = &code->GetInstruction(frame->idx);
+      args = code->GetArguments(*inst);
+      script_idx = inst->idx;
       // dispose returning value
-      frame->void_call = command->first.option.void_call; 
+      frame->void_call = inst->option.void_call; 
 
       //Built-in machine commands.
-      if (command->first.type == kRequestCommand) {
-        MachineCommands(command->first.GetKeywordValue(), command->second, command->first);
+      if (inst->type == kRequestCommand) {
+        MachineCommands(inst, args);
         
-        if (command->first.GetKeywordValue() == kKeywordReturn) refresh_tick();
+        if (inst->keyword == kKeywordReturn) refresh_tick();
 
         if (frame->error) {
-          script_idx = command->first.idx;
+          script_idx = inst->idx;
           break;
         }
 
@@ -2910,15 +3457,47 @@ namespace kagami {
 
       //cleaning object map for user-defined function and C++ function
       obj_map.clear();
+      me = Object();
 
       //Query function(Interpreter built-in or user-defined)
       //error string will be generated in FetchFunctionImpl.
-      if (command->first.type == kRequestFunction) {
-        if (!FetchFunctionImpl(impl, command, obj_map)) break;
+      if (inst->type == kRequestFunction) {
+        if (!FetchFunctionImpl(impl, inst, me)) break;
+      }
+
+      //C++ function with positional arguments doesn't need object map
+      if (impl->IsPositional()) {
+        GeneratePositionalArgs(*impl, args, positional_args);
+
+        if (frame->error) {
+          script_idx = inst->idx;
+          break;
+        }
+
+        if (impl->HasSignature() && !impl->CheckSignature(positional_args, signature_error)) {
+          msg = Message(signature_error, kStateError);
+          interface_error = true;
+          break;
+        }
+
+        ObjectView view(me, positional_args, impl->GetParameters());
+        msg = impl->GetPositionalActivity()(view);
+        positional_args.clear();
+
+        if (msg.GetLevel() == kStateError) {
+          interface_error = true;
+          break;
+        }
+
+        frame->RefreshReturnStack(std::move(msg.GetObj()));
+        frame->Stepping();
+        continue;
       }
 
+      if (!me.Null()) obj_map.emplace(NamedObject(kStrMe, me));
+
       //Build object map for function call expressed by command
-      GenerateArgs(*impl, command->second, obj_map);
+      GenerateArgs(*impl, args, obj_map);
 
       if (frame->initializer_calling) {
         GenerateStructInstance(obj_map);
@@ -2926,7 +3505,7 @@ namespace kagami {
 
       if (frame->error) {
         //Get actual script index for error reporting
-        script_idx = command->first.idx;
+        script_idx = inst->idx;
         break;
       }
 
@@ -2934,7 +3513,7 @@ namespace kagami {
       //Ceate new stack frame and push VMCode pointer to machine stack,
       //and start new processing in next tick.
       if (impl->GetType() == kFunctionVMCode) {
-        if (IsTailRecursion(frame->idx, &impl->GetCode())) tail_recursion();
+        if (IsTailRecursion(frame->idx, *impl)) tail_recursion();
         else if (IsTailCall(frame->idx)) tail_call(*impl);
         else update_stack_frame(*impl);
 
@@ -2945,7 +3524,7 @@ namespace kagami {
 
         if (frame->error) {
           //Get actual script index for error reporting
-          script_idx = command->first.idx;
+          script_idx = inst->idx;
           break;
         }
 
@@ -2954,7 +3533,7 @@ namespace kagami {
       }
       else if (impl->GetType() == kFunctionCXX) {
         //calling C++ functions.
-        msg = impl->GetActivity()(obj_map);
+        msg = impl->CallActivity(obj_map);
 
         if (msg.GetLevel() == kStateError) {
           interface_error = true;
@@ -2976,14 +3555,14 @@ namespace kagami {
         }
         else {
           //calling method.
-          msg = impl->GetActivity()(obj_map);
+          msg = impl->CallActivity(obj_map);
           frame->Stepping();
         }
         continue;
       }
       
       //Pushing returning value to returning stack.
-      frame->RefreshReturnStack(msg.GetObj());
+      frame->RefreshReturnStack(std::move(msg.GetObj()));
       //indicator + 1
       frame->Stepping();
     }
@@ -3001,6 +3580,7 @@ namespace kagami {
 
     if (!invoking || (invoking && frame_stack_.size() != stop_point)) {
       obj_stack_.Pop();
+      frame_stack_.top().ClearReturnStack();
       frame_stack_.pop();
       code_stack_.pop_back();
     }
@@ -10,26 +10,27 @@
 
 #define EXPECTED_COUNT(_Count) (args.size() == _Count)
 
-namespace kagami {
-  using Expect = pair<string, string>;
-  using ExpectationList = initializer_list<Expect>;
-  using NullableList = initializer_list<string>;
-
-  CommentedResult TypeChecking(ExpectationList &&lst,
-    ObjectMap &obj_map,
-    NullableList &&nullable = {});
-
-#define TC_ERROR(_Obj) Message(std::get<string>(_Obj), kStateError)
-#define TC_FAIL(_Obj) !std::get<bool>(_Obj)
+//Computed-goto dispatching on GCC/Clang, switch is used on MSVC
+#if defined(__GNUC__) || defined(__clang__)
+#define THREADED_DISPATCH
+#endif
 
+namespace kagami {
   using management::type::PlainComparator;
 
-  PlainType FindTypeCode(string type_id);
+  //Default budget of event polling while machine is hanging
+  const size_t kDefaultPollInterval = 256;
+  const int64_t kDefaultPollPeriod = 1000;
+  //Used when refresh rate of display is unknown
+  const int64_t kDefaultFrameRate = 60;
+  //Instructions between clock checks of redraw scheduler
+  const int64_t kRedrawCheckInterval = 64;
+
+  PlainType FindTypeCode(TypeId type);
   int64_t IntProducer(Object &obj);
   double FloatProducer(Object &obj);
   string StringProducer(Object &obj);
   bool BoolProducer(Object &obj);
-  string ParseRawString(const string &src);
   void InitPlainTypesAndConstants();
   void ActivateComponents();
   void ReceiveError(void* vm, const char* msg);
@@ -191,12 +192,94 @@ namespace kagami {
 
   const string kIteratorBehavior = "obj|step_forward|__compare";
   const string kContainerBehavior = "head|tail";
-  const string kForEachExceptions = "!iterator|!containter_keepalive";
+  const string kTypeIdForEachCursor = "!foreach_cursor";
+  const vector<string> kForEachExceptions = {
+    kStrIteratorObj, kStrContainerKeepAliveSlot
+  };
 
-  using CommandPointer = Command * ;
+  using InstructionPointer = Instruction * ;
   using EventHandlerMark = pair<Uint32, Uint32>;
   using EventHandler = pair<EventHandlerMark, FunctionImpl>;
 
+  //Resolved variable of a frame slot. It's checked against the scopes
+  //between lookup start and owner, so changes elsewhere keep it valid.
+  struct SlotRecord {
+    Object *ptr;
+    ObjectContainer *scope;
+    ObjectContainer *owner;
+    size_t stamp;
+    uint64_t name_bit;
+
+    SlotRecord() : ptr(nullptr), scope(nullptr), owner(nullptr),
+      stamp(0), name_bit(0) {}
+  };
+
+  //Variable declared in running function body. It's bound to the scope
+  //where it was looked up and checked against that scope and the owner.
+  struct LocalSlot {
+    Object *ptr;
+    ObjectContainer *scope;
+    ObjectContainer *owner;
+    size_t stamp;
+
+    LocalSlot() : ptr(nullptr), scope(nullptr), owner(nullptr), stamp(0) {}
+  };
+
+  const size_t kOperandStackReserve = 256;
+
+  /* Operand stack shared by all frames of one machine. Every frame keeps
+     the base where its own values begin, so temporaries of a frame are
+     dropped by truncating the stack to that base. */
+  class OperandStack {
+  private:
+    vector<Object> base_;
+
+  public:
+    OperandStack() : base_() { base_.reserve(kOperandStackReserve); }
+
+    void Push(const Object &obj) { base_.push_back(obj); }
+    void Push(Object &&obj) { base_.push_back(std::move(obj)); }
+    void Pop() { base_.pop_back(); }
+    Object &Top() { return base_.back(); }
+    size_t Size() const { return base_.size(); }
+
+    void Truncate(size_t size) {
+      if (size < base_.size()) base_.erase(base_.begin() + size, base_.end());
+    }
+  };
+
+  enum CursorType {
+    kCursorArray, kCursorTable, kCursorString, kCursorWideString, kCursorRange
+  };
+
+  /* Native cursor of for-each loop over built-in containers. The machine
+     advances it directly instead of invoking head/tail/step_forward.
+     Cursor doesn't own the container. It's read from keep-alive slot on
+     every step, so the loop isn't seen as another holder of its content.
+     Array content is pinned while loop unit refers to its elements. */
+  class ForEachCursor {
+  private:
+    CursorType type_;
+    TypeId container_type_;
+    void *base_;
+    void *pinned_;
+    size_t idx_;
+    vector<Object> table_keys_;
+    ObjectTable::iterator table_it_;
+    IntegerRange range_;
+
+  public:
+    ForEachCursor(CursorType type, Object &container);
+    ForEachCursor(const ForEachCursor &) = delete;
+    ~ForEachCursor();
+
+    bool AtEnd(Object &container);
+    void StepForward();
+    Object Unpack();
+  };
+
+  shared_ptr<ForEachCursor> CreateForEachCursor(Object &container);
+
   class RuntimeFrame {
   public:
     bool error;
@@ -212,19 +295,22 @@ namespace kagami {
     bool inside_initializer_calling;
     Object struct_base;
     Object assert_rc_copy;
-    size_t jump_offset;
+    //End of function body in compiled unit, indicator is absolute
+    size_t code_end;
     size_t idx;
     string msg_string;
     string function_scope;
     string struct_id;
     string super_struct_id;
-    stack<bool> condition_stack; //preserved
-    stack<bool> scope_stack;
-    stack<size_t> jump_stack;
-    stack<size_t> branch_jump_stack;
-    stack<Object> return_stack;
-
-    RuntimeFrame(string scope = kStrRootScope) :
+    OperandStack *operands;
+    size_t stack_base;
+    vector<SlotRecord> slots;
+    vector<LocalSlot> local_slots;
+    //Scope of function call refers to copy-on-write objects of closure
+    //record, so the record is kept until the frame is popped.
+    shared_ptr<ObjectMap> closure_record;
+
+    RuntimeFrame(OperandStack &operands, string scope = kStrRootScope) :
       error(false),
       warning(false),
       activated_continue(false),
@@ -237,23 +323,105 @@ namespace kagami {
       initializer_calling(false),
       inside_initializer_calling(false),
       assert_rc_copy(),
-      jump_offset(0),
+      code_end(0),
       idx(0),
       msg_string(),
       function_scope(),
       struct_id(),
       super_struct_id(),
-      condition_stack(),
-      jump_stack(),
-      branch_jump_stack(),
-      return_stack() {}
+      operands(&operands),
+      stack_base(operands.Size()),
+      slots(),
+      local_slots(),
+      closure_record() {}
 
     void Stepping();
     void Goto(size_t taget_idx);
-    void AddJumpRecord(size_t target_idx);
+    void SetCodeRange(size_t begin, size_t end);
     void MakeError(string str);
     void MakeWarning(string str);
-    void RefreshReturnStack(Object obj = Object());
+    void RefreshReturnStack(const Object &obj = Object());
+    void RefreshReturnStack(Object &&obj);
+    void Reset(OperandStack &operands);
+
+    bool ReturnStackEmpty() const { return operands->Size() <= stack_base; }
+    Object &ReturnStackTop() { return operands->Top(); }
+    void PopReturnStack() { operands->Pop(); }
+    void ClearReturnStack() { operands->Truncate(stack_base); }
+  };
+
+  /* Stack of runtime frames. Popped frames are kept and reset on next
+     push, so containers inside of them keep their capacity between calls. */
+  class FrameStack {
+  private:
+    deque<RuntimeFrame> frames_;
+    size_t size_;
+
+  public:
+    FrameStack() : frames_(), size_(0) {}
+
+    RuntimeFrame &top() { return frames_[size_ - 1]; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    RuntimeFrame &push(OperandStack &operands) {
+      if (size_ < frames_.size()) frames_[size_].Reset(operands);
+      else frames_.emplace_back(operands);
+      return frames_[size_++];
+    }
+
+    void pop() {
+      //release objects held by frame
+      frames_[size_ - 1].struct_base = Object();
+      frames_[size_ - 1].assert_rc_copy = Object();
+      frames_[size_ - 1].closure_record.reset();
+      --size_;
+    }
+  };
+
+  /* Windows are presented at most once per frame interval in offensive
+     mode. Frame rate follows current display mode unless script sets it. */
+  class RedrawScheduler {
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::duration interval_;
+    Clock::time_point next_frame_;
+    Clock::time_point last_frame_;
+    int64_t frame_rate_;
+    int64_t countdown_;
+    bool pending_;
+    size_t frames_;
+    Clock::duration last_frame_time_;
+    Clock::duration total_frame_time_;
+    Clock::duration max_frame_time_;
+    Clock::duration draw_time_;
+
+    void Present(Clock::time_point now);
+
+  public:
+    RedrawScheduler() :
+      interval_(), next_frame_(), last_frame_(),
+      frame_rate_(0), countdown_(1), pending_(false), frames_(0),
+      last_frame_time_(), total_frame_time_(),
+      max_frame_time_(), draw_time_() {}
+
+    void Start(int64_t frame_rate);
+    Object GetStatistics() const;
+
+    void Tick() {
+      pending_ = true;
+      if (--countdown_ > 0) return;
+      countdown_ = kRedrawCheckInterval;
+      auto now = Clock::now();
+      if (now >= next_frame_) Present(now);
+    }
+
+    //Present changes made after last frame at once. Used before the
+    //machine blocks or stops drawing, where Tick() won't run for a while.
+    void Flush() {
+      if (pending_) Present(Clock::now());
+    }
   };
 
   struct _IgnoredException : std::exception {};
@@ -275,7 +443,7 @@ namespace kagami {
 
   private:
     ObjectStack &obj_stack_;
-    stack<RuntimeFrame> &frame_stack_;
+    FrameStack &frame_stack_;
     toml::value toml_file_;
 
   private:
@@ -298,7 +466,7 @@ namespace kagami {
       const toml::value &elem_def, dawn::PlainWindow &window);
   public:
     ConfigProcessor() = delete;
-    ConfigProcessor(ObjectStack &obj_stack, stack<RuntimeFrame> &frames, string file) noexcept :
+    ConfigProcessor(ObjectStack &obj_stack, FrameStack &frames, string file) noexcept :
       obj_stack_(obj_stack), frame_stack_(frames), toml_file_() {
       try { toml_file_ = toml::parse(file); }
       catch (std::runtime_error &e) {
@@ -324,96 +492,113 @@ namespace kagami {
   private:
     void RecoverLastState();
     void FinishInitalizerCalling();
-    bool IsTailRecursion(size_t idx, VMCode *code);
+    bool IsTailRecursion(size_t idx, FunctionImpl &impl);
     bool IsTailCall(size_t idx);
 
     Object FetchPlainObject(Argument &arg);
     Object FetchFunctionObject(string id);
     Object FetchObject(Argument &arg, bool checking = false);
+    Object *FindObjectBySlot(const string &id, size_t slot, bool local);
 
     //deprecated. Use a sub-machine to replace it.
     bool _FetchFunctionImpl(FunctionImplPointer &impl, string id, string type_id);
     
-    bool FetchFunctionImpl(FunctionImplPointer &impl, CommandPointer &command,
-      ObjectMap &obj_map);
+    FunctionImpl *FindFunctionByCache(Instruction &inst, const string &id,
+      TypeId type);
+    bool FetchFunctionImpl(FunctionImplPointer &impl, InstructionPointer &inst,
+      Object &me);
 
-    void ClosureCatching(ArgumentList &args, size_t nest_end, bool closure);
+    void ClosureCatching(ArgumentView &args, RequestOption &option, bool closure);
 
     Message Invoke(Object obj, string id, 
       const initializer_list<NamedObject> &&args = {});
 
-    void CommandIfOrWhile(Keyword token, ArgumentList &args, size_t nest_end);
-    void CommandForEach(ArgumentList &args, size_t nest_end);
-    void ForEachChecking(ArgumentList &args, size_t nest_end);
-    void CommandCase(ArgumentList &args, size_t nest_end);
-    void CommandElse();
-    void CommandWhen(ArgumentList &args);
-    void CommandContinueOrBreak(Keyword token, size_t escape_depth);
-    void CommandStructBegin(ArgumentList &args);
-    void CommandModuleBegin(ArgumentList &args);
-    void CommandConditionEnd();
+    void CommandIfOrWhile(Keyword token, ArgumentView &args, size_t target);
+    void CommandForEach(ArgumentView &args, size_t nest_end);
+    void ForEachChecking(ArgumentView &args, size_t nest_end);
+    void BindForEachUnit(const string &unit_id, const Object &unit);
+    void CommandCase(ArgumentView &args, size_t target);
+    void CommandWhen(ArgumentView &args, size_t target);
+    void CommandContinueOrBreak(Keyword token, size_t escape_depth, size_t target);
+    void CommandStructBegin(ArgumentView &args);
+    void CommandModuleBegin(ArgumentView &args);
     void CommandLoopEnd(size_t nest);
     void CommandForEachEnd(size_t nest);
     void CommandStructEnd();
     void CommandModuleEnd();
-    void CommandInclude(ArgumentList &args);
-    void CommandSuper(ArgumentList &args);
-
-    void CommandHash(ArgumentList &args);
-    void CommandSwap(ArgumentList &args);
-    void CommandBind(ArgumentList &args, bool local_value, bool ext_value);
-    void CommandDelivering(ArgumentList &args, bool local_value, bool ext_value);
-    void CommandTypeId(ArgumentList &args);
-    void CommandMethods(ArgumentList &args);
-    void CommandExist(ArgumentList &args);
-    void CommandNullObj(ArgumentList &args);
-    void CommandDestroy(ArgumentList &args);
-    void CommandConvert(ArgumentList &args);
-    void CommandUsing(ArgumentList &args);
-    void CommandUsingTable(ArgumentList &args);
-    void CommandApplyLayout(ArgumentList &args);
-    void CommandOffensiveMode(ArgumentList &args);
+    void CommandInclude(ArgumentView &args);
+    void CommandSuper(ArgumentView &args);
+
+    void CommandHash(ArgumentView &args);
+    void CommandSwap(ArgumentView &args);
+    void CommandBind(ArgumentView &args, bool local_value, bool ext_value);
+    void CommandDelivering(ArgumentView &args, bool local_value, bool ext_value);
+    void CommandTypeId(ArgumentView &args);
+    void CommandMethods(ArgumentView &args);
+    void CommandExist(ArgumentView &args);
+    void CommandNullObj(ArgumentView &args);
+    void CommandDestroy(ArgumentView &args);
+    void CommandConvert(ArgumentView &args);
+    void CommandUsing(ArgumentView &args);
+    void CommandUsingTable(ArgumentView &args);
+    void CommandApplyLayout(ArgumentView &args);
+    void CommandOffensiveMode(ArgumentView &args);
+    void CommandEventPolling(ArgumentView &args);
+    void CommandFrameStats();
 
     void CommandTime();
     void CommandVersion();
     void CommandMachineCodeName();
 
     template <Keyword op_code>
-    void BinaryMathOperatorImpl(ArgumentList &args);
+    void BinaryMathOperatorImpl(Instruction &inst, ArgumentView &args);
 
     template <Keyword op_code>
-    void BinaryLogicOperatorImpl(ArgumentList &args);
-
-    void OperatorLogicNot(ArgumentList &args);
-
-    void ExpList(ArgumentList &args);
-    void InitArray(ArgumentList &args);
-
-    void CommandReturn(ArgumentList &args);
-    void CommandAssert(ArgumentList &args);
-    void CommandHandle(ArgumentList &args);
-    void CommandWait(ArgumentList &args);
-    void CommandLeave(ArgumentList &args);
-    void DomainAssert(ArgumentList &args);
-    void MachineCommands(Keyword token, ArgumentList &args, Request &request);
-
-    void GenerateArgs(FunctionImpl &impl, ArgumentList &args, ObjectMap &obj_map);
-    void Generate_Fixed(FunctionImpl &impl, ArgumentList &args, ObjectMap &obj_map);
-    void Generate_AutoSize(FunctionImpl &impl, ArgumentList &args, ObjectMap &obj_map);
-    void Generate_AutoFill(FunctionImpl &impl, ArgumentList &args, ObjectMap &obj_map);
+    void BinaryLogicOperatorImpl(Instruction &inst, ArgumentView &args);
+
+    void OperatorLogicNot(ArgumentView &args);
+
+    void ExpList(ArgumentView &args);
+    void InitArray(ArgumentView &args);
+
+    void CommandReturn(ArgumentView &args);
+    void CommandAssert(ArgumentView &args);
+    void CommandHandle(ArgumentView &args);
+    void CommandWait(ArgumentView &args);
+    void CommandLeave(ArgumentView &args);
+    void DomainAssert(ArgumentView &args);
+    void LogicShortCircuit(Instruction &inst, ArgumentView &args);
+    bool FetchNextCommand(InstructionPointer &inst, ArgumentView &args);
+    void MachineCommands(InstructionPointer &inst, ArgumentView &args);
+
+    void GenerateArgs(FunctionImpl &impl, ArgumentView &args, ObjectMap &obj_map);
+    void Generate_Fixed(FunctionImpl &impl, ArgumentView &args, ObjectMap &obj_map);
+    void Generate_AutoSize(FunctionImpl &impl, ArgumentView &args, ObjectMap &obj_map);
+    void Generate_AutoFill(FunctionImpl &impl, ArgumentView &args, ObjectMap &obj_map);
+    void GeneratePositionalArgs(FunctionImpl &impl, ArgumentView &args, vector<Object> &dest);
     void LoadEventInfo(SDL_Event &event, ObjectMap &obj_map, FunctionImpl &impl, Uint32 id);
     void CallExtensionFunction(ObjectMap &p, FunctionImpl &impl);
 
     void GenerateStructInstance(ObjectMap &p);
   private:
     deque<VMCodePointer> code_stack_;
-    stack<RuntimeFrame> frame_stack_;
+    OperandStack operand_stack_;
+    FrameStack frame_stack_;
     ObjectStack obj_stack_;
     map<EventHandlerMark, FunctionImpl> event_list_;
     bool hanging_;
     bool freezing_;
     bool error_;
     bool offensive_;
+    //SDL_PollEvent is called after poll_interval_ instructions when
+    //poll_period_ is passed since last polling
+    size_t poll_interval_;
+    size_t poll_countdown_;
+    std::chrono::microseconds poll_period_;
+    std::chrono::steady_clock::time_point last_poll_;
+    RedrawScheduler redraw_;
+
+    bool IsEventPollingDue();
 
   public:
     ~Machine() { if (is_logger_host_) delete logger_; }
@@ -427,13 +612,19 @@ namespace kagami {
       logger_(nullptr),
       is_logger_host_(true),
       code_stack_(),
+      operand_stack_(),
       frame_stack_(),
       obj_stack_(),
       event_list_(), 
       hanging_(false), 
       freezing_(false),
       error_(false),
-      offensive_(false) { 
+      offensive_(false),
+      poll_interval_(kDefaultPollInterval),
+      poll_countdown_(1),
+      poll_period_(kDefaultPollPeriod),
+      last_poll_(),
+      redraw_() { 
 
       code_stack_.push_back(&ir); 
       logger_ = rtlog ?
@@ -445,13 +636,19 @@ namespace kagami {
       logger_(logger),
       is_logger_host_(false),
       code_stack_(),
+      operand_stack_(),
       frame_stack_(),
       obj_stack_(),
       event_list_(),
       hanging_(false),
       freezing_(false),
       error_(false),
-      offensive_(false) {
+      offensive_(false),
+      poll_interval_(kDefaultPollInterval),
+      poll_countdown_(1),
+      poll_period_(kDefaultPollPeriod),
+      last_poll_(),
+      redraw_() {
 
       code_stack_.push_back(&ir);
     }
@@ -468,8 +665,7 @@ namespace kagami {
     }
 
     void Run(bool invoking = false, string id = "", 
-      VMCodePointer ptr = nullptr, ObjectMap *p = nullptr, 
-      ObjectMap *closure_record = nullptr);
+      FunctionImplPointer func = nullptr, ObjectMap *p = nullptr);
 
     bool ErrorOccurred() const {
       return error_;
@@ -14,6 +14,16 @@ namespace kagami::management {
     return cache;
   }
 
+  //Inline caches of call sites are dropped when it's changed.
+  size_t &GetImplVersionValue() {
+    static size_t version = 1;
+    return version;
+  }
+
+  size_t GetImplVersion() {
+    return GetImplVersionValue();
+  }
+
   void BuildFunctionImplCache(string domain) {
     auto &base = GetFunctionImplCache();
     auto &col = GetFunctionImplCollections().at(domain);
@@ -36,6 +46,7 @@ namespace kagami::management {
     }
 
     BuildFunctionImplCache(domain);
+    GetImplVersionValue() += 1;
   }
 
   FunctionImpl *FindFunction(string id, string domain) {
@@ -98,68 +109,84 @@ namespace kagami::management::type {
 
   vector<string> GetMethods(string id) {
     vector<string> result;
-    const auto it = GetObjectTraitsCollection().find(id);
+    auto *traits = InternTypeId(id)->traits;
 
-    if (it != GetObjectTraitsCollection().end()) {
-      result = it->second.GetMethods();
+    if (traits != nullptr) {
+      result = traits->GetMethods();
     }
     return result;
   }
 
-  bool CheckMethod(string func_id, string domain) {
-    bool result = false;
-    const auto it = GetObjectTraitsCollection().find(domain);
-
-    if (it != GetObjectTraitsCollection().end()) {
-      result = find_in_vector(func_id, it->second.GetMethods());
-    }
+  bool CheckMethod(const string &func_id, TypeId domain) {
+    return domain->traits != nullptr && domain->traits->HasMethod(func_id);
+  }
 
-    return result;
+  bool CheckMethod(const string &func_id, const string &domain) {
+    return CheckMethod(func_id, InternTypeId(domain));
   }
 
   size_t GetHash(Object &obj) {
-    auto &base = GetObjectTraitsCollection();
-    const auto it = base.find(obj.GetTypeId());
-    auto hasher = it->second.GetHasher();
+    switch (obj.GetInlineType()) {
+    case kInlineInt: return std::hash<int64_t>()(obj.Cast<int64_t>());
+    case kInlineFloat: return std::hash<double>()(obj.Cast<double>());
+    case kInlineBool: return std::hash<bool>()(obj.Cast<bool>());
+    default: break;
+    }
+
+    auto hasher = obj.GetTypeRecord()->traits->GetHasher();
     return hasher(obj.Get());
   }
 
   bool IsHashable(Object &obj) {
-    bool result = false;
-    auto &base = GetObjectTraitsCollection();
-    const auto it = base.find(obj.GetTypeId());
+    auto *traits = obj.GetTypeRecord()->traits;
+    return traits != nullptr && traits->GetHasher() != nullptr;
+  }
 
-    if (it != base.end()) {
-      result = (it->second.GetHasher() != nullptr);
-    }
+  bool IsCopyable(Object &obj) {
+    auto *traits = obj.GetTypeRecord()->traits;
+    return traits != nullptr && traits->GetDeliveringImpl() != ShallowDelivery;
+  }
 
-    return result;
+  void CreateObjectTraits(string id, ObjectTraits temp) {
+    auto it = GetObjectTraitsCollection().insert(pair<string, ObjectTraits>(id, temp)).first;
+    InternTypeId(id)->traits = &it->second;
   }
 
-  bool IsCopyable(Object &obj) {
-    bool result = false;
-    auto &base = GetObjectTraitsCollection();
-    const auto it = base.find(obj.GetTypeId());
+  //TODO:External/Delegator object processing
+  //Content which is referred by for-each loop unit is written in place,
+  //so it isn't shared with new copies until the loop is finished.
+  auto &GetPinnedContents() {
+    static unordered_map<void *, size_t> base;
+    return base;
+  }
 
-    if (it != base.end()) {
-      result = (it->second.GetDeliveringImpl() != ShallowDelivery);
-    }
+  bool IsPinnedContent(Object &object) {
+    auto &base = GetPinnedContents();
+    return !base.empty() && base.find(object.Get().get()) != base.end();
+  }
 
-    return result;
+  void PinContent(void *content) {
+    GetPinnedContents()[content] += 1;
   }
 
-  void CreateObjectTraits(string id, ObjectTraits temp) {
-    GetObjectTraitsCollection().insert(pair<string, ObjectTraits>(id, temp));
+  void UnpinContent(void *content) {
+    auto &base = GetPinnedContents();
+    auto it = base.find(content);
+    if (it != base.end() && --it->second == 0) base.erase(it);
   }
 
-  //TODO:External/Delegator object processing
   Object CreateObjectCopy(Object &object) {
     if (object.GetDeliveringFlag()) {
       return object;
     }
 
+    //Inline value needs no delivering implementation
+    if (object.IsInline()) {
+      return object;
+    }
+
     Object result;
-    const auto it = GetObjectTraitsCollection().find(object.GetTypeId());
+    auto *traits = object.GetTypeRecord()->traits;
 
     if (object.GetMode() == kObjectExternal) {
       //TODO:Implementations (After finishing callback facility for types)
@@ -168,31 +195,57 @@ namespace kagami::management::type {
       result = object;
     }
     else if (object.IsSubContainer() && object.GetTypeId() != kTypeIdStruct) {
-      auto &instance_src = object.Cast<ObjectStruct>();
-      auto &base = instance_src.GetContent();
+      //Struct instance is copied on write
+      result.PackContent(object.Get(), object.GetTypeRecord());
+      result.SetContainerFlag();
+    }
+    else if (traits != nullptr) {
+      if (traits->IsCopyOnWrite() && !IsPinnedContent(object)) {
+        result.PackContent(object.Get(), object.GetTypeRecord());
+      }
+      else {
+        auto deliver = traits->GetDeliveringImpl();
+        result.PackContent(deliver(object.Get()), object.GetTypeRecord());
+      }
+    }
+
+    return result;
+  }
+
+  //Must be called before modifying content of copy-on-write object or
+  //handing out references into it. Works on the real object if it's a
+  //reference, so the variable itself receives the private copy.
+  void DetachSharedContent(Object &object) {
+    auto &real = object.Unpack();
+
+    if (!real.IsShared()) return;
+
+    if (real.IsSubContainer() && real.GetTypeId() != kTypeIdStruct) {
+      auto &base = real.Cast<ObjectStruct>().GetContent();
       auto managed_instance = make_shared<ObjectStruct>();
       for (auto &unit : base) {
         auto copy = CreateObjectCopy(unit.second);
         managed_instance->Add(unit.first, copy);
       }
-      result = Object(managed_instance, object.GetTypeId());
-      result.SetContainerFlag();
-    }
-    else if (it != GetObjectTraitsCollection().end()) {
-      auto deliver = it->second.GetDeliveringImpl();
-      result.PackContent(deliver(object.Get()), object.GetTypeId());
+      real.PackContent(managed_instance, real.GetTypeRecord());
+      return;
     }
 
-    return result;
+    auto *traits = real.GetTypeRecord()->traits;
+
+    if (traits != nullptr && traits->IsCopyOnWrite()) {
+      auto deliver = traits->GetDeliveringImpl();
+      real.PackContent(deliver(real.Get()), real.GetTypeRecord());
+    }
   }
 
   bool CheckBehavior(Object obj, string method_str) {
-    auto obj_methods = GetMethods(obj.GetTypeId());
+    auto type = obj.GetTypeRecord();
     auto sample = BuildStringVector(method_str);
     bool result = true;
 
     for (auto &unit : sample) {
-      if (!find_in_vector(unit, obj_methods)) {
+      if (!CheckMethod(unit, type)) {
         result = false;
         break;
       }
@@ -202,13 +255,12 @@ namespace kagami::management::type {
   }
 
   bool CompareObjects(Object &lhs, Object &rhs) {
-    if (lhs.GetTypeId() != rhs.GetTypeId()) return false;
-    auto &collection = GetObjectTraitsCollection();
-    const auto it = collection.find(lhs.GetTypeId());
+    if (lhs.GetTypeRecord() != rhs.GetTypeRecord()) return false;
+    auto *traits = lhs.GetTypeRecord()->traits;
     bool value = false;
 
-    if (it != collection.end()) {
-      auto comparator = it->second.GetComparator();
+    if (traits != nullptr) {
+      auto comparator = traits->GetComparator();
       if (comparator != nullptr) value = comparator(lhs, rhs);
       else value = (lhs.Get() == rhs.Get());
     }
@@ -232,7 +284,8 @@ namespace kagami::management::type {
   }
 
   ObjectTraitsSetup::~ObjectTraitsSetup() {
-    CreateObjectTraits(type_id_, ObjectTraits(delivering_impl_, methods_, hasher_, comparator_));
+    CreateObjectTraits(type_id_,
+      ObjectTraits(delivering_impl_, methods_, hasher_, comparator_, copy_on_write_));
     CreateImpl(delivering_);
     for (auto &unit : impl_) {
       CreateImpl(unit, type_id_);
@@ -247,7 +300,6 @@ namespace kagami::management::script {
   }
 
   VMCode *FindScriptByPath(string path) {
-    VMCode result = nullptr;
     auto &storage = GetScriptStorage();
     auto it = storage.find(path);
     
@@ -316,18 +368,21 @@ namespace kagami::management::extension {
     }
   }
 
-  inline ObjectType MatchExtType(string type_id) {
-    auto result = kExtUnsupported;
-    auto it = kExtTypeMatcher.find(type_id);
-    if (it != kExtTypeMatcher.end()) result = it->second;
-    return result;
+  inline ObjectType MatchExtType(TypeId type) {
+    if (!type->ext_matched) {
+      auto it = kExtTypeMatcher.find(type->name);
+      type->ext_type = it != kExtTypeMatcher.end() ? it->second : kExtUnsupported;
+      type->ext_matched = true;
+    }
+
+    return static_cast<ObjectType>(type->ext_type);
   }
 
   int FetchDescriptor(Descriptor *descriptor, void *obj_map, const char *id) {
     auto *source = static_cast<ObjectMap *>(obj_map);
     auto it = source->find(string(id));
     if (it == source->end()) return 0;
-    *descriptor = Descriptor{ &it->second, MatchExtType(it->second.GetTypeId()) };
+    *descriptor = Descriptor{ &it->second, MatchExtType(it->second.GetTypeRecord()) };
     return 1;
   }
 
@@ -340,7 +395,7 @@ namespace kagami::management::extension {
     auto &arr = arr_obj.Cast<ObjectArray>();
     if (index >= arr.size()) return 0;
     void *elem_ptr = &arr[index];
-    *dest = Descriptor{ elem_ptr, MatchExtType(arr[index].GetTypeId()) };
+    *dest = Descriptor{ elem_ptr, MatchExtType(arr[index].GetTypeRecord()) };
     return 1;
   }
 
@@ -390,7 +445,7 @@ namespace kagami::management::extension {
     auto &obj = *static_cast<ObjectPointer>(descriptor->ptr);
 
     if (descriptor->type == kExtUnsupported) return -1;
-    if (descriptor->type != MatchExtType(obj.GetTypeId())) return 0;
+    if (descriptor->type != MatchExtType(obj.GetTypeRecord())) return 0;
 
     auto is_string = [](auto type) -> bool {
       return type == kExtTypeString || type == kExtTypeWideString; };
@@ -406,7 +461,7 @@ namespace kagami::management::extension {
       switch (descriptor->type) {
       case kExtTypeInt:_DumpObjectA<int64_t>(obj, dest); break;
       case kExtTypeFloat:_DumpObjectA<double>(obj, dest); break;
-      case kExtTypeBool:_DumpObjectA<int>(obj, dest); break;
+      case kExtTypeBool:*dest = new int(obj.Cast<bool>() ? 1 : 0); break;
       case kExtTypeFunctionPointer:
         _DumpObjectA<GenericFunctionPointer>(obj, dest);break;
       case kExtTypeObjectPointer:_DumpObjectA<GenericPointer>(obj, dest); break;
@@ -10,6 +10,7 @@ namespace kagami::management {
 
   void CreateImpl(FunctionImpl impl, string domain = kTypeIdNull);
   FunctionImpl *FindFunction(string id, string domain = kTypeIdNull);
+  size_t GetImplVersion();
 
   Object *CreateConstantObject(string id, Object &object);
   Object *CreateConstantObject(string id, Object &&object);
@@ -28,12 +29,16 @@ namespace kagami::management::type {
   }
 
   vector<string> GetMethods(string id);
-  bool CheckMethod(string func_id, string domain);
+  bool CheckMethod(const string &func_id, TypeId domain);
+  bool CheckMethod(const string &func_id, const string &domain);
   size_t GetHash(Object &obj);
   bool IsHashable(Object &obj);
   bool IsCopyable(Object &obj);
   void CreateObjectTraits(string id, ObjectTraits temp);
   Object CreateObjectCopy(Object &object);
+  void DetachSharedContent(Object &object);
+  void PinContent(void *content);
+  void UnpinContent(void *content);
   bool CheckBehavior(Object obj, string method_str);
   bool CompareObjects(Object &lhs, Object &rhs);
 
@@ -44,6 +49,7 @@ namespace kagami::management::type {
     DeliveryImpl delivering_impl_;
     Comparator comparator_;
     HasherFunction hasher_;
+    bool copy_on_write_;
     vector<FunctionImpl> impl_;
     FunctionImpl delivering_;  //deprecated
 
@@ -57,11 +63,12 @@ namespace kagami::management::type {
       type_id_(type_name),
       delivering_impl_(dlvy),
       comparator_(nullptr),
-      hasher_(hasher) {}
+      hasher_(hasher),
+      copy_on_write_(false) {}
 
     ObjectTraitsSetup(string type_name, DeliveryImpl dlvy) :
       type_id_(type_name), delivering_impl_(dlvy), 
-      comparator_(nullptr), hasher_(nullptr) {}
+      comparator_(nullptr), hasher_(nullptr), copy_on_write_(false) {}
 
     //TODO:multi constructor injector
     ObjectTraitsSetup &InitConstructor(FunctionImpl impl) {
@@ -73,6 +80,11 @@ namespace kagami::management::type {
       comparator_ = comparator; return *this; 
     }
 
+    //Copies share content, delivering impl runs at first modification
+    ObjectTraitsSetup &InitCopyOnWrite() {
+      copy_on_write_ = true; return *this;
+    }
+
     ObjectTraitsSetup &InitMethods(initializer_list<FunctionImpl> &&rhs);
     ~ObjectTraitsSetup();
   };
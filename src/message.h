@@ -9,39 +9,56 @@ namespace kagami {
     kStateWarning
   };
 
+  /* Result of function calling and diagnostic message of front end.
+     Returning value is stored inline, so a successful call doesn't need any
+     allocation just to report itself. Detail text is kept empty unless the
+     message carries an error, a warning or an invoking request.
+  */
   class Message {
   private:
     bool invoking_msg_;
+    bool has_object_;
     StateLevel level_;
     string detail_;
-    shared_ptr<void> object_;
+    Object object_;
     size_t idx_;
 
   public:
     Message() :
       invoking_msg_(false),
-      level_(kStateNormal), 
-      detail_(""), 
+      has_object_(false),
+      level_(kStateNormal),
+      detail_(),
+      object_(),
       idx_(0) {}
 
     Message(const Message &msg) :
       invoking_msg_(msg.invoking_msg_),
+      has_object_(msg.has_object_),
       level_(msg.level_),
       detail_(msg.detail_),
       object_(msg.object_),
       idx_(msg.idx_) {}
 
-    Message(const Message &&msg) :
-      Message(msg) {}
+    Message(Message &&msg) noexcept :
+      invoking_msg_(msg.invoking_msg_),
+      has_object_(msg.has_object_),
+      level_(msg.level_),
+      detail_(std::move(msg.detail_)),
+      object_(std::move(msg.object_)),
+      idx_(msg.idx_) {}
 
     Message(string detail, StateLevel level = kStateNormal) :
       invoking_msg_(false),
-      level_(level), 
-      detail_(detail), 
+      has_object_(false),
+      level_(level),
+      detail_(detail),
+      object_(),
       idx_(0) {}
 
     Message &operator=(Message &msg) {
       invoking_msg_ = msg.invoking_msg_;
+      has_object_ = msg.has_object_;
       level_ = msg.level_;
       detail_ = msg.detail_;
       object_ = msg.object_;
@@ -49,56 +66,60 @@ namespace kagami {
       return *this;
     }
 
-    Message &operator=(Message &&msg) {
-      return this->operator=(msg);
+    Message &operator=(Message &&msg) noexcept {
+      invoking_msg_ = msg.invoking_msg_;
+      has_object_ = msg.has_object_;
+      level_ = msg.level_;
+      detail_ = std::move(msg.detail_);
+      object_ = std::move(msg.object_);
+      idx_ = msg.idx_;
+      return *this;
     }
 
     StateLevel GetLevel() const { return level_; }
     string GetDetail() const { return detail_; }
     size_t GetIndex() const { return idx_; }
-    bool HasObject() const { return object_ != nullptr; }
+    bool HasObject() const { return has_object_; }
     bool IsInvokingMsg() const { return invoking_msg_; }
 
-    Object GetObj() const {
-      if (object_ == nullptr) return Object();
-      return *static_pointer_cast<Object>(object_);
-    }
+    //Null object is returned if nothing is set.
+    Object &GetObj() { return object_; }
+    const Object &GetObj() const { return object_; }
 
     Message &SetObject(Object &object) {
-      object_ = make_shared<Object>(object);
+      object_ = object;
+      has_object_ = true;
       return *this;
     }
 
     Message &SetObject(bool value) {
-      object_ = make_shared<Object>(
-        make_shared<bool>(value), kTypeIdBool
-      );
+      object_ = Object(value, GetInlineTypeId(kInlineBool));
+      has_object_ = true;
       return *this;
     }
 
     Message &SetObject(int64_t value) {
-      object_ = make_shared<Object>(
-        make_shared<int64_t>(value), kTypeIdInt
-        );
+      object_ = Object(value, GetInlineTypeId(kInlineInt));
+      has_object_ = true;
       return *this;
     }
 
     Message &SetObject(double value) {
-      object_ = make_shared<Object>(
-        make_shared<double>(value), kTypeIdFloat
-        );
+      object_ = Object(value, GetInlineTypeId(kInlineFloat));
+      has_object_ = true;
       return *this;
     }
 
     Message &SetObject(string value) {
-      object_ = make_shared<Object>(
-        make_shared<string>(value), kTypeIdString
-        );
+      object_ = Object(make_shared<string>(value), kTypeIdString);
+      has_object_ = true;
       return *this;
     }
 
     Message &SetObject(Object &&object) {
-      return this->SetObject(object);
+      object_ = std::move(object);
+      has_object_ = true;
+      return *this;
     }
 
     Message &SetLevel(StateLevel level) {
@@ -125,7 +146,8 @@ namespace kagami {
       level_ = kStateNormal;
       detail_.clear();
       detail_.shrink_to_fit();
-      object_.reset();
+      object_ = Object();
+      has_object_ = false;
       idx_ = 0;
     }
   };
@@ -34,46 +34,129 @@ namespace kagami {
     return target;
   }
 
+  TypeId InternTypeId(const string &name) {
+    //unordered_map keeps element address stable during rehashing
+    static unordered_map<string, TypeRecord> base;
+    auto it = base.find(name);
+
+    if (it == base.end()) {
+      TypeRecord record{ base.size(), name, kInlineNone, kNotPlainType, 
+        name == kTypeIdStruct, false, 0, nullptr };
+
+      if (name == kTypeIdInt) {
+        record.inline_type = kInlineInt;
+        record.plain_type = kPlainInt;
+      }
+      else if (name == kTypeIdFloat) {
+        record.inline_type = kInlineFloat;
+        record.plain_type = kPlainFloat;
+      }
+      else if (name == kTypeIdBool) {
+        record.inline_type = kInlineBool;
+        record.plain_type = kPlainBool;
+      }
+      else if (name == kTypeIdString) {
+        record.plain_type = kPlainString;
+      }
+
+      it = base.emplace(name, record).first;
+    }
+
+    return &it->second;
+  }
+
+  TypeId GetInlineTypeId(InlineType type) {
+    static TypeId records[] = {
+      InternTypeId(kTypeIdNull), InternTypeId(kTypeIdInt),
+      InternTypeId(kTypeIdFloat), InternTypeId(kTypeIdBool)
+    };
+
+    return records[type];
+  }
+
+  TypeId GetStringTypeId() {
+    static TypeId record = InternTypeId(kTypeIdString);
+    return record;
+  }
+
   Object &Object::operator=(const Object &object) {
     if (object.mode_ == kObjectRef) {
       real_dest_ = object.real_dest_;
       ptr_.reset();
     }
     else {
-      real_dest_ = nullptr;
+      CopyValue(object);
       ptr_ = object.ptr_;
     }
 
-    type_id_ = object.type_id_;
+    inline_type_ = object.mode_ == kObjectRef ? kInlineNone : object.inline_type_;
+    type_ = object.type_;
     mode_ = object.mode_;
     delivering_ = object.delivering_;
     sub_container_ = object.sub_container_;
     return *this;
   }
 
-  Object &Object::PackContent(shared_ptr<void> ptr, string type_id) {
+  Object &Object::operator=(Object &&object) noexcept {
+    if (&object == this) return *this;
+
+    if (object.mode_ == kObjectRef) {
+      real_dest_ = object.real_dest_;
+      ptr_.reset();
+    }
+    else {
+      CopyValue(object);
+      ptr_ = std::move(object.ptr_);
+    }
+
+    inline_type_ = object.mode_ == kObjectRef ? kInlineNone : object.inline_type_;
+    type_ = object.type_;
+    mode_ = object.mode_;
+    delivering_ = object.delivering_;
+    sub_container_ = object.sub_container_;
+    return *this;
+  }
+
+  Object &Object::PackContent(shared_ptr<void> ptr, TypeId type) {
     if (mode_ == kObjectRef) {
       return static_cast<ObjectPointer>(real_dest_)
-        ->PackContent(ptr, type_id);
+        ->PackContent(ptr, type);
     }
 
-    ptr_ = ptr;
-    type_id_ = type_id;
+    if (mode_ == kObjectNormal && ptr != nullptr && type->inline_type != kInlineNone) {
+      switch (type->inline_type) {
+      case kInlineInt: AssignInlineValue(*static_pointer_cast<int64_t>(ptr), type); break;
+      case kInlineFloat: AssignInlineValue(*static_pointer_cast<double>(ptr), type); break;
+      default: AssignInlineValue(*static_pointer_cast<bool>(ptr), type); break;
+      }
+      ptr_.reset();
+    }
+    else {
+      if (inline_type_ != kInlineNone) real_dest_ = nullptr;
+      inline_type_ = kInlineNone;
+      ptr_ = ptr;
+    }
+
+    type_ = type;
     return *this;
   }
 
   Object &Object::swap(Object &obj) {
     ptr_.swap(obj.ptr_);
-    std::swap(type_id_, obj.type_id_);
+    std::swap(type_, obj.type_);
     std::swap(mode_, obj.mode_);
+    std::swap(inline_type_, obj.inline_type_);
     std::swap(delivering_, obj.delivering_);
-    std::swap(real_dest_, obj.real_dest_);
+    //int64_t covers every member of the value union
+    static_assert(sizeof(int64_t) >= sizeof(void *), "unexpected pointer size");
+    std::swap(int_value_, obj.int_value_);
     return *this;
   }
 
   Object &Object::PackObject(Object &object) {
     ptr_.reset();
-    type_id_ = object.type_id_;
+    inline_type_ = kInlineNone;
+    type_ = object.type_;
     mode_ = kObjectRef;
 
     if (!object.IsRef()) {
@@ -86,11 +169,15 @@ namespace kagami {
     return *this;
   }
 
+  size_t ObjectContainer::layout_clock_ = 0;
+
   void ObjectContainer::BuildCache() {
     dest_map_.clear();
+    name_mask_ = 0;
     const auto begin = base_.begin(), end = base_.end();
     for (auto it = begin; it != end; ++it) {
       dest_map_.insert(make_pair(it->first, &it->second));
+      name_mask_ |= GetNameBit(it->first);
     }
   }
 
@@ -101,6 +188,7 @@ namespace kagami {
     auto result = base_.emplace(NamedObject(id, source));
     if (result.second) {
       dest_map_.emplace(make_pair(id, &result.first->second));
+      name_mask_ |= GetNameBit(id);
     }
 
     return true;
@@ -111,6 +199,8 @@ namespace kagami {
 
     base_[id] = source;
     dest_map_[id] = &base_[id];
+    name_mask_ |= GetNameBit(id);
+    TouchErase();
   }
 
   bool ObjectContainer::Dispose(string id) {
@@ -122,11 +212,54 @@ namespace kagami {
     if (result) {
       base_.erase(it);
       dest_map_.erase(id);
+      TouchErase();
     }
 
     return result;
   }
 
+  Object *ObjectContainer::FindWithOwner(const string &id, ObjectContainer *&owner) {
+    if (IsDelegated()) return delegator_->FindWithOwner(id, owner);
+
+    if (!base_.empty()) {
+      auto it = dest_map_.find(id);
+
+      if (it != dest_map_.end()) {
+        owner = this;
+        return it->second;
+      }
+    }
+
+    if (prev_ != nullptr) return prev_->FindWithOwner(id, owner);
+
+    owner = nullptr;
+    return nullptr;
+  }
+
+  //Object added to this container may hide an object of outer scopes.
+  //Lookups bound to this container are dropped in that case.
+  void ObjectContainer::CheckShadowing(const string &id) {
+    if (IsDelegated()) return delegator_->CheckShadowing(id);
+
+    auto name_bit = GetNameBit(id);
+    auto *container = prev_;
+
+    while (container != nullptr) {
+      if (container->IsDelegated()) {
+        container = container->delegator_;
+        continue;
+      }
+
+      if ((container->name_mask_ & name_bit) &&
+        container->dest_map_.find(id) != container->dest_map_.end()) {
+        TouchLink();
+        return;
+      }
+
+      container = container->prev_;
+    }
+  }
+
   Object *ObjectContainer::Find(string id, bool forward_seeking) {
     if (IsDelegated()) return delegator_->Find(id, forward_seeking);
 
@@ -209,10 +342,48 @@ namespace kagami {
       }
     }
 
+    if (!base_.empty()) TouchErase();
     base_.swap(dest);
     BuildCache();
   }
 
+  //Loop scope reset between iterations. Unlike Clear(), hash buckets
+  //are kept and the cache isn't rebuilt.
+  void ObjectContainer::ResetIteration() {
+    if (IsDelegated()) return delegator_->ResetIteration();
+    if (base_.empty()) return;
+
+    base_.clear();
+    dest_map_.clear();
+    name_mask_ = 0;
+    TouchErase();
+  }
+
+  //Objects in exceptions and the loop unit stay in place, so pointers to
+  //them are still valid.
+  void ObjectContainer::ResetIteration(const vector<string> &exceptions,
+    const string &unit_id) {
+    if (IsDelegated()) return delegator_->ResetIteration(exceptions, unit_id);
+
+    bool disposed = false;
+    uint64_t name_mask = 0;
+
+    for (auto it = base_.begin(); it != base_.end();) {
+      if (it->first == unit_id || find_in_vector(it->first, exceptions)) {
+        name_mask |= GetNameBit(it->first);
+        ++it;
+        continue;
+      }
+
+      dest_map_.erase(it->first);
+      it = base_.erase(it);
+      disposed = true;
+    }
+
+    name_mask_ = name_mask;
+    if (disposed) TouchErase();
+  }
+
   ObjectMap &ObjectMap::operator=(const initializer_list<NamedObject> &rhs) {
     this->clear();
     for (const auto &unit : rhs) {
@@ -249,6 +420,24 @@ namespace kagami {
     }
   }
 
+  //Copy-on-write content in closure record is referenced instead of being
+  //shared, so modification on it still stays in the record between calls.
+  void ObjectStack::MergeClosureRecord(ObjectMap *p) {
+    if (p == nullptr || p->empty()) return;
+
+    auto &container = base_.back();
+    for (auto &unit : *p) {
+      auto &real = unit.second.Unpack();
+      auto *traits = real.GetTypeRecord()->traits;
+      bool copy_on_write = (real.IsSubContainer() && real.GetTypeId() != kTypeIdStruct)
+        || (traits != nullptr && traits->IsCopyOnWrite());
+
+      container.Add(unit.first, unit.second.IsRef() || copy_on_write ?
+        Object().PackObject(real) :
+        unit.second);
+    }
+  }
+
   Object *ObjectStack::Find(string id) {
     if (base_.empty() && prev_ == nullptr) return nullptr;
     ObjectPointer ptr = base_.back().Find(id);
@@ -260,6 +449,20 @@ namespace kagami {
     return ptr;
   }
 
+  //Owner is nullptr if object isn't found in scope chain of current stack.
+  Object *ObjectStack::FindWithOwner(const string &id, ObjectContainer *&owner) {
+    owner = nullptr;
+    if (base_.empty() && prev_ == nullptr) return nullptr;
+
+    ObjectPointer ptr = base_.empty() ? nullptr : base_.back().FindWithOwner(id, owner);
+
+    if (prev_ != nullptr && ptr == nullptr) {
+      ptr = prev_->Find(id);
+    }
+
+    return ptr;
+  }
+
   Object *ObjectStack::Find(string id, string domain) {
     if (base_.empty() && prev_ == nullptr) return nullptr;
     ObjectPointer ptr = base_.back().FindWithDomain(id, domain);
@@ -282,6 +485,7 @@ namespace kagami {
 
     if (top.Find(id, false) == nullptr) {
       top.Add(id, obj);
+      top.CheckShadowing(id);
     }
     else {
       return false;
@@ -51,6 +51,8 @@ namespace kagami {
     Comparator comparator_;
     HasherFunction hasher_;
     vector<string> methods_;
+    unordered_set<string> method_set_;
+    bool copy_on_write_;
 
   public:
     ObjectTraits() = delete;
@@ -59,16 +61,21 @@ namespace kagami {
       DeliveryImpl dlvy,
       string methods,
       HasherFunction hasher = nullptr,
-      Comparator comparator = nullptr) :
+      Comparator comparator = nullptr,
+      bool copy_on_write = false) :
       delivering_impl_(dlvy),
       comparator_(comparator),
       methods_(BuildStringVector(methods)),
-      hasher_(hasher) {}
+      method_set_(methods_.begin(), methods_.end()),
+      hasher_(hasher),
+      copy_on_write_(copy_on_write) {}
 
     vector<string> &GetMethods() { return methods_; }
+    bool HasMethod(const string &id) const { return method_set_.count(id) > 0; }
     HasherFunction GetHasher() { return hasher_; }
     Comparator GetComparator() { return comparator_; }
     DeliveryImpl GetDeliveringImpl() { return delivering_impl_; }
+    bool IsCopyOnWrite() const { return copy_on_write_; }
   };
 
   class ExternalRCContainer {
@@ -87,70 +94,216 @@ namespace kagami {
       ptr_(ptr), disposer_(disposer), type_id_(type_id) {}
   };
 
+  //Plain values stored inside Object without heap allocation
+  enum InlineType {
+    kInlineNone,
+    kInlineInt,
+    kInlineFloat,
+    kInlineBool
+  };
+
+  /* Interned type identity. Every type id string maps to exactly one record
+     for the lifetime of runtime, so Object keeps a pointer to it and type
+     comparison/traits lookup don't need any string operation.
+  */
+  struct TypeRecord {
+    size_t id;
+    string name;
+    InlineType inline_type;
+    PlainType plain_type;
+    bool is_struct;
+    bool ext_matched;
+    int ext_type;               //lazily matched by extension facilities
+    ObjectTraits *traits;       //nullptr if traits are not registered
+  };
+
+  using TypeId = TypeRecord *;
+
+  TypeId InternTypeId(const string &name);
+  TypeId GetInlineTypeId(InlineType type);
+  TypeId GetStringTypeId();
+
   //TODO:delegator mode
   class Object {
   private:
-    void *real_dest_;
+    //real_dest_ is only used by reference/delegator/external object,
+    //so it shares storage with inline values.
+    union {
+      void *real_dest_;
+      int64_t int_value_;
+      double float_value_;
+      bool bool_value_;
+    };
     ObjectMode mode_;
+    InlineType inline_type_;
     bool delivering_;
     bool sub_container_;
     shared_ptr<void> ptr_;
-    string type_id_;
+    TypeId type_;
+
+    template <typename T>
+    bool AssignInlineValue(const T &value, TypeId type) {
+      if constexpr (std::is_arithmetic_v<T>) {
+        switch (type->inline_type) {
+        case kInlineInt: int_value_ = static_cast<int64_t>(value); break;
+        case kInlineFloat: float_value_ = static_cast<double>(value); break;
+        case kInlineBool: bool_value_ = static_cast<bool>(value); break;
+        default: return false;
+        }
+
+        inline_type_ = type->inline_type;
+        return true;
+      }
+
+      return false;
+    }
+
+    void CopyValue(const Object &obj) {
+      switch (obj.inline_type_) {
+      case kInlineInt: int_value_ = obj.int_value_; break;
+      case kInlineFloat: float_value_ = obj.float_value_; break;
+      case kInlineBool: bool_value_ = obj.bool_value_; break;
+      default: real_dest_ = obj.real_dest_; break;
+      }
+    }
+
+    template <typename Tx>
+    Tx *GetInlineValue() {
+      if constexpr (std::is_same_v<Tx, int64_t>) {
+        if (inline_type_ == kInlineInt) return &int_value_;
+      }
+      else if constexpr (std::is_same_v<Tx, double>) {
+        if (inline_type_ == kInlineFloat) return &float_value_;
+      }
+      else if constexpr (std::is_same_v<Tx, bool>) {
+        if (inline_type_ == kInlineBool) return &bool_value_;
+      }
+
+      return nullptr;
+    }
 
   public:
     ~Object() {}
 
-    Object() : real_dest_(nullptr), mode_(kObjectNormal), delivering_(false),
-      sub_container_(false), ptr_(nullptr), type_id_(kTypeIdNull) {}
+    Object() : real_dest_(nullptr), mode_(kObjectNormal), inline_type_(kInlineNone),
+      delivering_(false), sub_container_(false), ptr_(nullptr), 
+      type_(GetInlineTypeId(kInlineNone)) {}
 
     Object(const Object &obj) :
-      real_dest_(obj.real_dest_), mode_(obj.mode_), delivering_(obj.delivering_),
-      sub_container_(obj.sub_container_), ptr_(obj.ptr_), type_id_(obj.type_id_) {}
+      mode_(obj.mode_), inline_type_(obj.inline_type_), delivering_(obj.delivering_),
+      sub_container_(obj.sub_container_), ptr_(obj.ptr_), type_(obj.type_) {
+      CopyValue(obj);
+    }
+
+    Object(Object &&obj) noexcept :
+      mode_(obj.mode_), inline_type_(obj.inline_type_), delivering_(obj.delivering_),
+      sub_container_(obj.sub_container_), ptr_(std::move(obj.ptr_)), type_(obj.type_) {
+      CopyValue(obj);
+    }
+
+    template <typename T>
+    Object(shared_ptr<T> ptr, TypeId type) :
+      real_dest_(nullptr), mode_(kObjectNormal), inline_type_(kInlineNone),
+      delivering_(false), sub_container_(type->is_struct), 
+      ptr_(), type_(type) {
+      if constexpr (std::is_arithmetic_v<T>) {
+        if (ptr != nullptr && AssignInlineValue(*ptr, type)) return;
+      }
+
+      ptr_ = ptr;
+    }
+
+    template <typename T>
+    Object(shared_ptr<T> ptr, const string &type_id) :
+      Object(ptr, InternTypeId(type_id)) {}
 
-    Object(const Object &&obj) noexcept :
-      Object(obj) {}
+    template <typename T>
+    Object(T &t, TypeId type) :
+      real_dest_(nullptr), mode_(kObjectNormal), inline_type_(kInlineNone),
+      delivering_(false), sub_container_(type->is_struct), 
+      ptr_(), type_(type) {
+      if (!AssignInlineValue(t, type)) ptr_ = make_shared<T>(t);
+    }
 
     template <typename T>
-    Object(shared_ptr<T> ptr, string type_id) :
-      real_dest_(nullptr), mode_(kObjectNormal), delivering_(false),
-      sub_container_(type_id == kTypeIdStruct), 
-      ptr_(ptr), type_id_(type_id) {}
+    Object(T &t, const string &type_id) :
+      Object(t, InternTypeId(type_id)) {}
 
     template <typename T>
-    Object(T &t, string type_id) :
-      real_dest_(nullptr), mode_(kObjectNormal), delivering_(false),
-      sub_container_(type_id == kTypeIdStruct), 
-      ptr_(make_shared<T>(t)), type_id_(type_id) {}
+    Object(T &&t, TypeId type) :
+      real_dest_(nullptr), mode_(kObjectNormal), inline_type_(kInlineNone),
+      delivering_(false), sub_container_(type->is_struct),
+      ptr_(), type_(type) {
+      if (!AssignInlineValue(t, type)) {
+        ptr_ = make_shared<std::decay_t<T>>(std::forward<T>(t));
+      }
+    }
 
     template <typename T>
-    Object(T &&t, string type_id) :
-      Object(t, type_id) {}
+    Object(T &&t, const string &type_id) :
+      Object(std::forward<T>(t), InternTypeId(type_id)) {}
 
     template <typename T>
-    Object(T *ptr, string type_id) :
-      real_dest_((void *)ptr), mode_(kObjectDelegator),  delivering_(false),
-      sub_container_(type_id == kTypeIdStruct), 
-      ptr_(nullptr), type_id_(type_id) {}
+    Object(T *ptr, const string &type_id) :
+      real_dest_((void *)ptr), mode_(kObjectDelegator), inline_type_(kInlineNone),
+      delivering_(false), sub_container_(false), 
+      ptr_(nullptr), type_(InternTypeId(type_id)) {
+      sub_container_ = type_->is_struct;
+    }
 
     Object(void *ext_ptr, ExternalMemoryDisposer disposer, string type_id) :
-      real_dest_(ext_ptr), mode_(kObjectExternal), delivering_(false), 
-      sub_container_(false), ptr_(make_shared<ExternalRCContainer>(ext_ptr, disposer, type_id)),
-      type_id_(type_id) {}
+      real_dest_(ext_ptr), mode_(kObjectExternal), inline_type_(kInlineNone),
+      delivering_(false), sub_container_(false), 
+      ptr_(make_shared<ExternalRCContainer>(ext_ptr, disposer, type_id)),
+      type_(InternTypeId(type_id)) {}
 
     Object(string str) :
-      real_dest_(nullptr), mode_(kObjectNormal), delivering_(false),
-      sub_container_(false), ptr_(make_shared<string>(str)), type_id_(kTypeIdString) {}
+      real_dest_(nullptr), mode_(kObjectNormal), inline_type_(kInlineNone),
+      delivering_(false), sub_container_(false), 
+      ptr_(make_shared<string>(str)), type_(GetStringTypeId()) {}
 
     Object &operator=(const Object &object);
-    Object &PackContent(shared_ptr<void> ptr, string type_id);
+    Object &PackContent(shared_ptr<void> ptr, TypeId type);
     Object &swap(Object &obj);
     Object &PackObject(Object &object);
 
+    Object &PackContent(shared_ptr<void> ptr, const string &type_id) {
+      return PackContent(ptr, InternTypeId(type_id));
+    }
+
+    template <typename T>
+    Object &PackValue(T value, TypeId type) {
+      if (mode_ == kObjectRef) {
+        return static_cast<ObjectPointer>(real_dest_)->PackValue(value, type);
+      }
+
+      if (mode_ != kObjectNormal || !AssignInlineValue(value, type)) {
+        return PackContent(make_shared<T>(value), type);
+      }
+
+      ptr_.reset();
+      type_ = type;
+      return *this;
+    }
+
+    template <typename T>
+    Object &PackValue(T value, const string &type_id) {
+      return PackValue(value, InternTypeId(type_id));
+    }
+
+    //Inline value is boxed for generic facilities
     shared_ptr<void> Get() {
       if (mode_ == kObjectRef) {
         return static_cast<ObjectPointer>(real_dest_)->Get();
       }
 
+      switch (inline_type_) {
+      case kInlineInt: return make_shared<int64_t>(int_value_);
+      case kInlineFloat: return make_shared<double>(float_value_);
+      case kInlineBool: return make_shared<bool>(bool_value_);
+      default: break;
+      }
+
       return ptr_;
     }
 
@@ -171,19 +324,33 @@ namespace kagami {
         return *static_cast<Tx *>(real_dest_);
       }
 
+      if (auto *value = GetInlineValue<Tx>(); value != nullptr) {
+        return *value;
+      }
+
       return *std::static_pointer_cast<Tx>(ptr_);
     }
 
-    Object &SetDeliveringFlag() {
+    Object &SetDeliveringFlag() & {
       delivering_ = true;
       return *this;
     }
 
-    Object &RemoveDeliveringFlag() {
+    Object &&SetDeliveringFlag() && {
+      delivering_ = true;
+      return std::move(*this);
+    }
+
+    Object &RemoveDeliveringFlag() & {
       delivering_ = false;
       return *this;
     }
 
+    Object &&RemoveDeliveringFlag() && {
+      delivering_ = false;
+      return std::move(*this);
+    }
+
     bool GetDeliveringFlag() {
       if (mode_ == kObjectRef) {
         return static_cast<ObjectPointer>(real_dest_)
@@ -215,11 +382,25 @@ namespace kagami {
 
     Object *GetRealDest() { return static_cast<ObjectPointer>(real_dest_); }
     void *GetExternalPointer() { return real_dest_; }
-    Object &operator=(const Object &&object) { return operator=(object); }
+    Object &operator=(Object &&object) noexcept;
     Object &swap(Object &&obj) { return swap(obj); }
-    string GetTypeId() const { return type_id_; }
+    const string &GetTypeId() const { return type_->name; }
+    TypeId GetTypeRecord() const { return type_; }
     bool IsRef() const { return mode_ == kObjectRef; }
-    bool Null() const { return ptr_ == nullptr && real_dest_ == nullptr; }
+
+    //Content is held by another object too
+    bool IsShared() {
+      if (mode_ == kObjectRef) {
+        return static_cast<ObjectPointer>(real_dest_)->IsShared();
+      }
+
+      return ptr_ != nullptr && ptr_.use_count() > 1;
+    }
+    bool IsInline() const { return inline_type_ != kInlineNone; }
+    InlineType GetInlineType() const { return inline_type_; }
+    bool Null() const {
+      return inline_type_ == kInlineNone && ptr_ == nullptr && real_dest_ == nullptr;
+    }
     ObjectMode GetMode() const { return mode_; }
     void SetContainerFlag() { sub_container_ = true; }
   };
@@ -229,12 +410,52 @@ namespace kagami {
   using ObjectPair = pair<Object, Object>;
   using ManagedPair = shared_ptr<ObjectPair>;
 
+  /* Lazy integer sequence in [start, stop) */
+  struct IntegerRange {
+    int64_t start;
+    int64_t stop;
+    int64_t step;
+
+    //Distances are computed in unsigned arithmetic, so wide ranges don't
+    //overflow. Size is saturated if it doesn't fit in int64_t.
+    uint64_t Distance() const {
+      return step > 0 ?
+        static_cast<uint64_t>(stop) - static_cast<uint64_t>(start) :
+        static_cast<uint64_t>(start) - static_cast<uint64_t>(stop);
+    }
+
+    uint64_t StepLength() const {
+      return step > 0 ? static_cast<uint64_t>(step) : 0 - static_cast<uint64_t>(step);
+    }
+
+    int64_t Size() const {
+      if ((step > 0 && start < stop) || (step < 0 && start > stop)) {
+        uint64_t size = (Distance() - 1) / StepLength() + 1;
+        return size > static_cast<uint64_t>(INT64_MAX) ?
+          INT64_MAX : static_cast<int64_t>(size);
+      }
+
+      return 0;
+    }
+
+    //Only valid for idx < Size()
+    int64_t At(int64_t idx) const {
+      return static_cast<int64_t>(static_cast<uint64_t>(start) +
+        static_cast<uint64_t>(idx) * static_cast<uint64_t>(step));
+    }
+  };
+
   class ObjectContainer {
   private:
     ObjectContainer *delegator_;
     ObjectContainer *prev_;
     map<string, Object> base_;
     unordered_map<string, Object *> dest_map_;
+    size_t link_stamp_;
+    size_t erase_stamp_;
+    uint64_t name_mask_;
+
+    static size_t layout_clock_;
 
     bool IsDelegated() const { 
       return delegator_ != nullptr; 
@@ -245,6 +466,11 @@ namespace kagami {
     }
 
     void BuildCache();
+
+    //Stamps are taken from one clock, so a stamp newer than a cached
+    //lookup means this container changed after the lookup.
+    void TouchLink() { link_stamp_ = ++layout_clock_; }
+    void TouchErase() { erase_stamp_ = ++layout_clock_; }
   public:
     bool Add(string id, Object source);
     void Replace(string id, Object source);
@@ -253,15 +479,59 @@ namespace kagami {
     Object *FindWithDomain(string id, string domain, bool forward_seeking = true);
     bool IsInside(Object *ptr);
     void ClearExcept(string exceptions);
+    void ResetIteration();
+    void ResetIteration(const vector<string> &exceptions, const string &unit_id);
+
+    Object *FindWithOwner(const string &id, ObjectContainer *&owner);
+    void CheckShadowing(const string &id);
+
+    //Walks the same path as Find(). Lookup result is still valid if path
+    //isn't relinked, no container before owner may hold the name now and
+    //nothing is erased from owner. Objects added elsewhere don't matter.
+    bool IsLookupValid(ObjectContainer *owner, uint64_t name_bit, size_t stamp) {
+      auto *container = this;
+
+      while (container != nullptr) {
+        if (container->link_stamp_ > stamp) return false;
+
+        if (container->IsDelegated()) {
+          container = container->delegator_;
+          continue;
+        }
+
+        if (container == owner) return container->erase_stamp_ <= stamp;
+        if (container->name_mask_ & name_bit) return false;
+
+        container = container->prev_;
+      }
+
+      return false;
+    }
+
+    //Objects are only added to current scope, and adding one that hides
+    //an outer object relinks the scope. So a lookup bound to this scope is
+    //checked against this scope and the owner without walking between.
+    bool IsBoundLookupValid(ObjectContainer *owner, size_t stamp) const {
+      return link_stamp_ <= stamp && owner->link_stamp_ <= stamp &&
+        owner->erase_stamp_ <= stamp;
+    }
+
+    static size_t GetLayoutClock() { return layout_clock_; }
+    static uint64_t GetNameBit(const string &id) {
+      return uint64_t(1) << (std::hash<string>()(id) & 63);
+    }
 
     ObjectContainer() : delegator_(nullptr),
-      prev_(nullptr), base_(), dest_map_() {}
+      prev_(nullptr), base_(), dest_map_(),
+      link_stamp_(++layout_clock_), erase_stamp_(link_stamp_), name_mask_(0) {}
 
     ObjectContainer(const ObjectContainer &&mgr) :
-    delegator_(mgr.delegator_), prev_(mgr.prev_) {}
+    delegator_(mgr.delegator_), prev_(mgr.prev_),
+      link_stamp_(++layout_clock_), erase_stamp_(link_stamp_), name_mask_(0) {}
 
     ObjectContainer(const ObjectContainer &container) :
-      delegator_(container.delegator_), prev_(container.prev_) {
+      delegator_(container.delegator_), prev_(container.prev_),
+      link_stamp_(++layout_clock_), erase_stamp_(link_stamp_), name_mask_(0) {
       if (!container.base_.empty()) {
         base_ = container.base_;
         BuildCache();
@@ -276,11 +546,25 @@ namespace kagami {
       if (IsDelegated()) return delegator_->operator=(mgr);
 
       base_ = mgr.base_;
+      BuildCache();
+      TouchErase();
       return *this;
     }
 
+    //Drop all content and links for reusing, hash buckets are kept
+    void Reset() {
+      TouchLink();
+      TouchErase();
+      delegator_ = nullptr;
+      prev_ = nullptr;
+      base_.clear();
+      dest_map_.clear();
+      name_mask_ = 0;
+    }
+
     void Clear() {
       if (IsDelegated()) delegator_->Clear();
+      if (!base_.empty()) TouchErase();
 
       base_.clear();
       BuildCache();
@@ -299,11 +583,13 @@ namespace kagami {
     ObjectContainer &SetPreviousContainer(ObjectContainer *prev) {
       if (IsDelegated()) return delegator_->SetPreviousContainer(prev);
       prev_ = prev;
+      TouchLink();
       return *this;
     }
 
     ObjectContainer &SetDelegatedContainer(ObjectContainer *dest) {
       delegator_ = dest;
+      TouchLink();
       return *this;
     }
   };
@@ -320,8 +606,8 @@ namespace kagami {
     ObjectMap(const ObjectMap &rhs) :
       map<string, Object>(rhs) {}
 
-    ObjectMap(const ObjectMap &&rhs) :
-      map<string, Object>(rhs) {}
+    ObjectMap(ObjectMap &&rhs) noexcept :
+      map<string, Object>(std::move(rhs)) {}
 
     ObjectMap(const initializer_list<NamedObject> &rhs) {
       this->clear();
@@ -336,8 +622,8 @@ namespace kagami {
     ObjectMap(const map<string, Object> &rhs) :
       map<string, Object>(rhs) {}
 
-    ObjectMap(const map<string, Object> &&rhs) :
-      map<string, Object>(rhs) {}
+    ObjectMap(map<string, Object> &&rhs) noexcept :
+      map<string, Object>(std::move(rhs)) {}
 
     ObjectMap &operator=(const initializer_list<NamedObject> &rhs);
     ObjectMap &operator=(const ObjectMap &rhs);
@@ -347,6 +633,11 @@ namespace kagami {
       return operator=(rhs);
     }
 
+    ObjectMap &operator=(ObjectMap &&rhs) noexcept {
+      map<string, Object>::operator=(std::move(rhs));
+      return *this;
+    }
+
     template <typename T>
     T &Cast(string id) {
       return this->operator[](id).Cast<T>();
@@ -369,11 +660,39 @@ namespace kagami {
     }
   };
 
+  /* Positional arguments of built-in function. Arguments are placed in
+     declared order of parameters, and names are kept for diagnostics.
+  */
+  class ObjectView {
+  private:
+    Object *me_;
+    Object *head_;
+    size_t size_;
+    const vector<string> *names_;
+
+  public:
+    ObjectView() = delete;
+    ObjectView(Object &me, vector<Object> &args, const vector<string> &names) :
+      me_(&me), head_(args.data()), size_(args.size()), names_(&names) {}
+
+    Object &operator[](size_t idx) { return head_[idx]; }
+    Object &Me() { return *me_; }
+    size_t size() const { return size_; }
+    const string &GetName(size_t idx) const { return (*names_)[idx]; }
+    const vector<string> &GetNames() const { return *names_; }
+
+    template <typename T>
+    T &Cast(size_t idx) {
+      return head_[idx].Cast<T>();
+    }
+  };
+
   class ObjectStack {
   private:
     using DataType = list<ObjectContainer>;
     ObjectContainer *root_container_;
     DataType base_;
+    DataType spare_;  //popped containers for reusing
     ObjectStack *prev_;
     bool delegated_;
 
@@ -381,12 +700,14 @@ namespace kagami {
     ObjectStack() :
       root_container_(nullptr),
       base_(),
+      spare_(),
       prev_(nullptr),
       delegated_(false) {}
 
     ObjectStack(const ObjectStack &rhs) :
       root_container_(rhs.root_container_),
       base_(rhs.base_),
+      spare_(),
       prev_(rhs.prev_),
       delegated_(false) {}
 
@@ -426,13 +747,21 @@ namespace kagami {
       }
 
       auto *prev = base_.empty() ? nullptr : &base_.back();
-      base_.emplace_back(ObjectContainer());
+
+      if (!spare_.empty()) {
+        base_.splice(base_.end(), spare_, std::prev(spare_.end()));
+      }
+      else {
+        base_.emplace_back(ObjectContainer());
+      }
+
       base_.back().SetPreviousContainer(prev);
       return *this;
     }
 
     ObjectStack &Pop() {
-      base_.pop_back();
+      base_.back().Reset();
+      spare_.splice(spare_.end(), base_, std::prev(base_.end()));
       return *this;
     }
 
@@ -441,8 +770,10 @@ namespace kagami {
     }
 
     void MergeMap(ObjectMap &p);
+    void MergeClosureRecord(ObjectMap *p);
     Object *Find(string id);
     Object *Find(string id, string domain);
+    Object *FindWithOwner(const string &id, ObjectContainer *&owner);
     bool CreateObject(string id, Object obj);
     bool DisposeObjectInCurrentScope(string id);
     bool DisposeObject(string id);
@@ -2,9 +2,6 @@
 
 namespace kagami {
   Message NewMusicObject(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("path", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     string path = p.Cast<string>("path");
     dawn::ManagedMusic music(new dawn::Music(path));
 
@@ -51,6 +48,7 @@ namespace kagami {
     ObjectTraitsSetup(kTypeIdMusic, ShallowDelivery, PointerHasher)
       .InitConstructor(
         FunctionImpl(NewMusicObject, "path", kTypeIdMusic)
+          .SetSignature({ Expect("path", kTypeIdString) })
       )
       .InitMethods(
         {
@@ -10,9 +10,6 @@ namespace kagami {
   ///////////////////////////////////////////////////////////////
   // InStream implementations
   Message NewInStream(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("path", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     string path = p.Cast<string>("path");
 
     shared_ptr<InStream> ifs = make_shared<InStream>(path);
@@ -41,14 +38,6 @@ namespace kagami {
   ///////////////////////////////////////////////////////////////
   // OutStream implementations
   Message NewOutStream(ObjectMap &p) {
-    auto tc = TypeChecking(
-      { 
-        Expect("path", kTypeIdString),
-        Expect("binary", kTypeIdBool),
-        Expect("append", kTypeIdBool)
-      }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
     string path = p.Cast<string>("path");
     bool binary = p.Cast<bool>("binary");
     bool append = p.Cast<bool>("append");
@@ -80,6 +69,7 @@ namespace kagami {
     ObjectTraitsSetup(kTypeIdInStream, ShallowDelivery, PointerHasher)
       .InitConstructor(
         FunctionImpl(NewInStream, "path", "instream")
+          .SetSignature({ Expect("path", kTypeIdString) })
       )
       .InitMethods(
         {
@@ -92,6 +82,13 @@ namespace kagami {
     ObjectTraitsSetup(kTypeIdOutStream, ShallowDelivery, PointerHasher)
       .InitConstructor(
         FunctionImpl(NewOutStream, "path|binary|append", "outstream")
+          .SetSignature(
+            {
+              Expect("path", kTypeIdString),
+              Expect("binary", kTypeIdBool),
+              Expect("append", kTypeIdBool)
+            }
+          )
       )
       .InitMethods(
         {
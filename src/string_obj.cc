@@ -5,11 +5,8 @@ namespace kagami {
     return compare(obj.GetTypeId(), kTypeIdString, kTypeIdWideString);
   }
 
-  Message CreateStringFromArray(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("src", kTypeIdArray) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto &base = p.Cast<ObjectArray>("src");
+  Message CreateStringFromArray(ObjectView &p) {
+    auto &base = p.Cast<ObjectArray>(0);
     shared_ptr<string> dest(make_shared<string>());
     
     for (auto it = base.begin(); it != base.end(); ++it) {
@@ -28,19 +25,13 @@ namespace kagami {
     return Message().SetObject(Object(dest, kTypeIdString));
   }
 
-  Message CharFromInt(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("value", kTypeIdInt) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto value = static_cast<char>(p.Cast<int64_t>("value"));
+  Message CharFromInt(ObjectView &p) {
+    auto value = static_cast<char>(p.Cast<int64_t>(0));
     return Message().SetObject(string().append(1, value));
   }
 
-  Message IntFromChar(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("value", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    auto &value = p.Cast<string>("value");
+  Message IntFromChar(ObjectView &p) {
+    auto &value = p.Cast<string>(0);
 
     if (value.size() != 1) {
       return Message("Invalid char", kStateError);
@@ -50,8 +41,8 @@ namespace kagami {
   }
 
   //String
-  Message NewString(ObjectMap &p) {
-    Object &obj = p["raw_string"];
+  Message NewString(ObjectView &p) {
+    Object &obj = p[0];
     Object base;
 
     if (!IsStringFamily(obj)) {
@@ -77,9 +68,9 @@ namespace kagami {
     return Message().SetObject(base);
   }
 
-  Message StringCompare(ObjectMap &p) {
-    auto &rhs = p[kStrRightHandSide];
-    string lhs = p[kStrMe].Cast<string>();
+  Message StringCompare(ObjectView &p) {
+    auto &rhs = p[0];
+    string lhs = p.Me().Cast<string>();
 
     string type_id = rhs.GetTypeId();
     bool result = false;
@@ -92,8 +83,8 @@ namespace kagami {
     return Message().SetObject(result);
   }
 
-  Message StringToArray(ObjectMap &p) {
-    auto &str = p.Cast<string>(kStrMe);
+  Message StringToArray(ObjectView &p) {
+    auto &str = p.Me().Cast<string>();
     shared_ptr<ObjectArray> base(make_shared<ObjectArray>());
 
     for (auto &unit : str) {
@@ -104,11 +95,8 @@ namespace kagami {
   }
 
   //wstring
-  Message NewWideString(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("raw_string", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    Object obj = p["raw_string"];
+  Message NewWideString(ObjectView &p) {
+    Object obj = p[0];
 
     string output = obj.Cast<string>();
     wstring wstr = s2ws(output);
@@ -117,9 +105,9 @@ namespace kagami {
       .SetObject(Object(make_shared<wstring>(wstr), kTypeIdWideString));
   }
 
-  Message WideStringCompare(ObjectMap &p) {
-    auto &rhs = p[kStrRightHandSide];
-    wstring lhs = p[kStrMe].Cast<wstring>();
+  Message WideStringCompare(ObjectView &p) {
+    auto &rhs = p[0];
+    wstring lhs = p.Me().Cast<wstring>();
     bool result = false;
     if (rhs.GetTypeId() == kTypeIdWideString) {
       wstring rhs_wstr = rhs.Cast<wstring>();
@@ -161,6 +149,7 @@ namespace kagami {
       .InitComparator(PlainComparator<wstring>)
       .InitConstructor(
         FunctionImpl(NewWideString, "raw_string", "wstring")
+          .SetSignature({ Expect("raw_string", kTypeIdString) })
       )
       .InitMethods(
         {
@@ -173,12 +162,18 @@ namespace kagami {
         }
     );
 
-    CreateImpl(FunctionImpl(DecimalConvert<2>, "str", "bin"));
-    CreateImpl(FunctionImpl(DecimalConvert<8>, "str", "octa"));
-    CreateImpl(FunctionImpl(DecimalConvert<16>, "str", "hex"));
-    CreateImpl(FunctionImpl(CreateStringFromArray, "src", "ar2string"));
-    CreateImpl(FunctionImpl(CharFromInt, "value", "int2str"));
-    CreateImpl(FunctionImpl(IntFromChar, "value", "str2int"));
+    CreateImpl(FunctionImpl(DecimalConvert<2>, "str", "bin")
+      .SetSignature({ Expect("str", kTypeIdString) }));
+    CreateImpl(FunctionImpl(DecimalConvert<8>, "str", "octa")
+      .SetSignature({ Expect("str", kTypeIdString) }));
+    CreateImpl(FunctionImpl(DecimalConvert<16>, "str", "hex")
+      .SetSignature({ Expect("str", kTypeIdString) }));
+    CreateImpl(FunctionImpl(CreateStringFromArray, "src", "ar2string")
+      .SetSignature({ Expect("src", kTypeIdArray) }));
+    CreateImpl(FunctionImpl(CharFromInt, "value", "int2str")
+      .SetSignature({ Expect("value", kTypeIdInt) }));
+    CreateImpl(FunctionImpl(IntFromChar, "value", "str2int")
+      .SetSignature({ Expect("value", kTypeIdString) }));
 
 
     EXPORT_CONSTANT(kTypeIdString);
@@ -3,20 +3,20 @@
 
 namespace kagami {
   template <typename StringType>
-  Message GetStringFamilySize(ObjectMap &p) {
-    StringType &str = p.Cast<StringType>(kStrMe);
+  Message GetStringFamilySize(ObjectView &p) {
+    StringType &str = p.Me().Cast<StringType>();
     int64_t size = static_cast<int64_t>(str.size());
     return Message().SetObject(size);
   }
   
   template <typename StringType>
-  Message StringFamilySubStr(ObjectMap &p) {
-    StringType &str = p.Cast<StringType>(kStrMe);
+  Message StringFamilySubStr(ObjectView &p) {
+    StringType &str = p.Me().Cast<StringType>();
 
-    string type_id = p[kStrMe].GetTypeId();
+    string type_id = p.Me().GetTypeId();
 
-    int64_t start = p.Cast<int64_t>("start");
-    int64_t size = p.Cast<int64_t>("size");
+    int64_t start = p.Cast<int64_t>(0);
+    int64_t size = p.Cast<int64_t>(1);
 
     if (start < 0 || size > static_cast<int64_t>(str.size() - start)) {
       return Message("Invalid index/size", kStateError);
@@ -28,12 +28,12 @@ namespace kagami {
   }
 
   template <typename StringType>
-  Message StringFamilyGetElement(ObjectMap &p) {
-    StringType &str = p.Cast<StringType>(kStrMe);
-    string type_id = p[kStrMe].GetTypeId();
+  Message StringFamilyGetElement(ObjectView &p) {
+    StringType &str = p.Me().Cast<StringType>();
+    string type_id = p.Me().GetTypeId();
 
     size_t size = str.size();
-    size_t idx = p.Cast<int64_t>("index");
+    size_t idx = p.Cast<int64_t>(0);
 
     if (idx >= size || idx < 0) return Message("Index is out of range", kStateError);
 
@@ -44,8 +44,8 @@ namespace kagami {
   }
 
   template<typename DestType,class SrcType>
-  Message StringFamilyConverting(ObjectMap &p) {
-    SrcType &str = p.Cast<SrcType>(kStrMe); 
+  Message StringFamilyConverting(ObjectView &p) {
+    SrcType &str = p.Me().Cast<SrcType>();
     string type_id;
     Message msg;
     shared_ptr<DestType> dest;
@@ -64,15 +64,10 @@ namespace kagami {
   }
 
   template <int base>
-  Message DecimalConvert(ObjectMap &p) {
-    auto tc = TypeChecking({ Expect("str", kTypeIdString) }, p);
-    if (TC_FAIL(tc)) return TC_ERROR(tc);
-
-    string str = ParseRawString(p["str"].Cast<string>());
+  Message DecimalConvert(ObjectView &p) {
+    string str = ParseRawString(p[0].Cast<string>());
 
     int64_t dest = stol(str, nullptr, base);
-    return Message().SetObject(Object(
-      make_shared<int64_t>(dest), kTypeIdInt
-    ));
+    return Message().SetObject(Object(dest, kTypeIdInt));
   }
 }
\ No newline at end of file
@@ -1,20 +1,201 @@
 #include "vmcode.h"
 
 namespace kagami {
-  bool VMCode::FindJumpRecord(size_t index, stack<size_t> &dest) {
-    if (source_ != nullptr) return source_->FindJumpRecord(index, dest);
+  string ParseRawString(const string &src) {
+    string result = src;
+    if (lexical::IsString(result)) result = lexical::GetRawString(result);
+    return result;
+  }
 
-    bool found = false;
-    while (!dest.empty()) dest.pop();
+  Object ParseLiteral(Argument &arg) {
+    auto type = arg.GetStringType();
+    auto &value = arg.GetData();
+    Object obj;
 
-    if (auto it = jump_record_.find(index); it != jump_record_.end()) {
-      for (auto rit = it->second.rbegin(); rit != it->second.rend(); ++rit) {
-        dest.push(*rit);
+    if (type == kStringTypeInt) {
+      int64_t int_value;
+      from_chars(value.data(), value.data() + value.size(), int_value);
+      obj.PackValue(int_value, GetInlineTypeId(kInlineInt));
+    }
+    else if (type == kStringTypeFloat) {
+      double float_value;
+#ifndef _MSC_VER
+      //dealing with issues of charconv implementation in low-version clang
+      float_value = stod(value);
+#else
+      from_chars(value.data(), value.data() + value.size(), float_value);
+#endif
+      obj.PackValue(float_value, GetInlineTypeId(kInlineFloat));
+    }
+    else {
+      switch (type) {
+      case kStringTypeBool:
+        obj.PackValue(value == kStrTrue, GetInlineTypeId(kInlineBool));
+        break;
+      case kStringTypeString:
+        obj.PackContent(make_shared<string>(ParseRawString(value)), kTypeIdString);
+        break;
+      case kStringTypeIdentifier:
+        obj.PackContent(make_shared<string>(value), kTypeIdString);
+        break;
+      default:
+        break;
       }
+    }
+
+    return obj;
+  }
+
+  //Flatten commands into instruction array. Machine runs lowered
+  //instructions only, function bodies refer to ranges of them.
+  void VMCode::Lowering() {
+    size_t operand_count = 0;
 
-      found = true;
+    for (auto &unit : *this) {
+      operand_count += unit.second.size() + 1;
     }
 
-    return found;
+    instructions_.clear();
+    operands_.clear();
+    identifiers_.clear();
+    constants_.clear();
+    instructions_.reserve(size());
+    operands_.reserve(operand_count);
+
+    auto push_operand = [&](Argument arg) -> void {
+      if (arg.GetType() == kArgumentNormal) {
+        arg.SetConstantIndex(constants_.size());
+        constants_.push_back(ParseLiteral(arg));
+      }
+
+      operands_.push_back(arg);
+    };
+
+    for (auto &unit : *this) {
+      Instruction inst;
+      auto &request = unit.first;
+
+      inst.type = request.type;
+      inst.keyword = request.GetKeywordValue();
+      inst.option = request.option;
+      inst.idx = request.idx;
+
+      if (request.type == kRequestFunction) {
+        inst.id = identifiers_.size();
+        inst.domain = operands_.size();
+        identifiers_.push_back(request.GetInterfaceId());
+        push_operand(request.GetInterfaceDomain());
+      }
+
+      inst.arg_head = operands_.size();
+      inst.arg_size = unit.second.size();
+
+      for (auto &arg : unit.second) {
+        push_operand(arg);
+      }
+
+      instructions_.push_back(inst);
+    }
+
+    ResolveSlots();
+  }
+
+  //Assign frame slot to every plain variable name in this code. Same name 
+  //shares one slot. Member access and asserted chain stay on name lookup.
+  //Function body runs in its own frame, so its slots are counted from zero.
+  //Names declared in the body (parameters, binding targets and loop units)
+  //get local slots. Other names are counted separately as outer slots.
+  void VMCode::ResolveSlots() {
+    auto is_fn = [](Instruction &inst) -> bool {
+      return inst.type == kRequestCommand && inst.keyword == kKeywordFn;
+    };
+
+    auto is_declaration = [](Argument &arg) -> bool {
+      return arg.GetType() == kArgumentNormal &&
+        arg.GetStringType() == kStringTypeIdentifier;
+    };
+
+    //Declared names of every body, keyed by its first instruction
+    unordered_map<size_t, unordered_set<string>> declared;
+    stack<pair<size_t, unordered_set<string> *>> bodies;
+    bodies.push(make_pair(instructions_.size(), &declared[0]));
+
+    for (size_t idx = 0; idx < instructions_.size(); ++idx) {
+      auto &inst = instructions_[idx];
+
+      while (idx >= bodies.top().first) bodies.pop();
+
+      for (size_t count = 0; count < inst.arg_size; ++count) {
+        auto &arg = operands_[inst.arg_head + count];
+        if (!is_declaration(arg)) continue;
+
+        //Parameters belong to the function body, function name doesn't
+        if (is_fn(inst) && count > 0) declared[idx + 1].insert(arg.GetData());
+        else bodies.top().second->insert(arg.GetData());
+      }
+
+      if (is_fn(inst)) {
+        bodies.push(make_pair(inst.option.nest_end, &declared[idx + 1]));
+      }
+    }
+
+    struct Region {
+      size_t end;
+      unordered_set<string> *declared;
+      unordered_map<string, size_t> local_slots;
+      unordered_map<string, size_t> outer_slots;
+    };
+
+    //Innermost function body on the top
+    stack<Region> regions;
+    regions.push(Region{ instructions_.size(), &declared[0], {}, {} });
+
+    auto get_slot = [&](const string &id, bool &local) -> size_t {
+      auto &region = regions.top();
+      local = region.declared->find(id) != region.declared->end();
+      auto &slot_map = local ? region.local_slots : region.outer_slots;
+      auto it = slot_map.find(id);
+      if (it != slot_map.end()) return it->second;
+      size_t slot = slot_map.size();
+      slot_map.emplace(id, slot);
+      return slot;
+    };
+
+    auto resolve = [&](Argument &arg) -> void {
+      bool variable = arg.GetType() == kArgumentObjectStack &&
+        arg.option.domain.empty() && !arg.option.use_last_assert;
+      bool local = false;
+
+      if (variable || is_declaration(arg)) {
+        size_t slot = get_slot(arg.GetData(), local);
+        arg.SetSlot(slot, local);
+      }
+    };
+
+    for (size_t idx = 0; idx < instructions_.size(); ++idx) {
+      auto &inst = instructions_[idx];
+
+      while (idx >= regions.top().end) regions.pop();
+
+      if (inst.type == kRequestFunction) {
+        auto &domain = operands_[inst.domain];
+        resolve(domain);
+
+        if (!inst.option.use_last_assert && domain.GetType() == kArgumentNull) {
+          inst.slot = get_slot(identifiers_[inst.id], inst.local_slot);
+        }
+      }
+
+      //Parameters are bound by name when the function is called
+      size_t arg_size = is_fn(inst) && inst.arg_size > 0 ? 1 : inst.arg_size;
+
+      for (size_t count = 0; count < arg_size; ++count) {
+        resolve(operands_[inst.arg_head + count]);
+      }
+
+      if (is_fn(inst)) {
+        regions.push(Region{ inst.option.nest_end, &declared[idx + 1], {}, {} });
+      }
+    }
   }
 }
\ No newline at end of file
@@ -16,6 +16,11 @@ namespace kagami {
     kRequestNull
   };
 
+  const size_t kInvalidSlot = static_cast<size_t>(-1);
+  const size_t kCallSiteCacheSize = 4;
+
+  class FunctionImpl;
+
   struct ArgumentOption {
     bool optional_param;
     bool variable_param;
@@ -40,6 +45,8 @@ namespace kagami {
     size_t nest;
     size_t nest_end;
     size_t escape_depth;
+    size_t skip_distance;
+    size_t jump_target;
     Keyword nest_root;
 
     RequestOption() : 
@@ -50,6 +57,8 @@ namespace kagami {
       nest(0),
       nest_end(0),
       escape_depth(0),
+      skip_distance(0),
+      jump_target(0),
       nest_root(kKeywordNull) {}
   };
 
@@ -58,6 +67,9 @@ namespace kagami {
     string data_;
     ArgumentType type_;
     StringType token_type_;
+    size_t constant_idx_;
+    size_t slot_;
+    bool local_slot_;
 
   public:
     ArgumentOption option;
@@ -67,6 +79,9 @@ namespace kagami {
       data_(),
       type_(kArgumentNull),
       token_type_(kStringTypeNull),
+      constant_idx_(0),
+      slot_(kInvalidSlot),
+      local_slot_(false),
       option() {}
 
     Argument(
@@ -76,6 +91,9 @@ namespace kagami {
       data_(data),
       type_(type),
       token_type_(token_type),
+      constant_idx_(0),
+      slot_(kInvalidSlot),
+      local_slot_(false),
       option() {}
 
     void SetDomain(string id, ArgumentType type) {
@@ -83,12 +101,22 @@ namespace kagami {
       option.domain_type = type;
     }
 
-    auto GetData() { return data_; }
+    const string &GetData() const { return data_; }
 
     auto GetType() { return type_; }
 
     StringType GetStringType() { return token_type_; }
 
+    void SetConstantIndex(size_t idx) { constant_idx_ = idx; }
+
+    size_t GetConstantIndex() const { return constant_idx_; }
+
+    void SetSlot(size_t slot, bool local) { slot_ = slot; local_slot_ = local; }
+
+    size_t GetSlot() const { return slot_; }
+
+    bool IsLocalSlot() const { return local_slot_; }
+
     bool IsPlaceholder() const {
       return type_ == kArgumentNull;
     }
@@ -155,26 +183,144 @@ namespace kagami {
     }
    };
 
+  string ParseRawString(const string &src);
+
   using ArgumentList = deque<Argument>;
   using Command = pair<Request, ArgumentList>;
 
+  struct CallSiteEntry {
+    TypeId type;
+    FunctionImpl *impl;
+  };
+
+  /* Inline cache of call site, keyed on receiver type. Null impl means
+     there's no built-in function for this type. */
+  struct CallSiteCache {
+    size_t version;
+    size_t size;
+    size_t next;
+    CallSiteEntry entries[kCallSiteCacheSize];
+
+    CallSiteCache() : version(0), size(0), next(0), entries() {}
+  };
+
+  //Operand types observed by operator instruction. Generic means the
+  //guard has failed once and the instruction stays on generic path.
+  enum OperandSpecialization {
+    kSpecializeNone,
+    kSpecializeInt,
+    kSpecializeFloat,
+    kSpecializeString,
+    kSpecializeGeneric
+  };
+
+  /* Lowered form of Command. Arguments and function ids are stored
+     in flat arrays of VMCode and referred by index. */
+  struct Instruction {
+    RequestType type;
+    Keyword keyword;
+    RequestOption option;
+    size_t idx;
+    size_t id;
+    size_t slot;
+    bool local_slot;
+    size_t domain;
+    size_t arg_head;
+    size_t arg_size;
+    CallSiteCache cache;
+    OperandSpecialization spec;
+
+    Instruction() :
+      type(kRequestNull),
+      keyword(kKeywordNull),
+      option(),
+      idx(0),
+      id(0),
+      slot(kInvalidSlot),
+      local_slot(false),
+      domain(0),
+      arg_head(0),
+      arg_size(0),
+      cache(),
+      spec(kSpecializeNone) {}
+  };
+
+  /* Non-owning view of instruction arguments */
+  class ArgumentView {
+  private:
+    Argument *head_;
+    size_t size_;
+
+  public:
+    using iterator = Argument *;
+    using reverse_iterator = std::reverse_iterator<Argument *>;
+
+    ArgumentView() : head_(nullptr), size_(0) {}
+    ArgumentView(Argument *head, size_t size) : head_(head), size_(size) {}
+
+    Argument &operator[](size_t idx) { return head_[idx]; }
+    Argument &front() { return head_[0]; }
+    Argument &back() { return head_[size_ - 1]; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    iterator begin() { return head_; }
+    iterator end() { return head_ + size_; }
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+  };
+
   class VMCode : public deque<Command> {
   protected:
-    VMCode *source_;
-    unordered_map<size_t, list<size_t>> jump_record_;
+    vector<Instruction> instructions_;
+    vector<Argument> operands_;
+    vector<string> identifiers_;
+    vector<Object> constants_;
+    //Identifiers referred by function bodies, keyed by index of 'fn'.
+    //Decided by front end.
+    unordered_map<size_t, vector<string>> free_variables_;
+
+    void ResolveSlots();
 
   public:
-    VMCode() : deque<Command>(), source_(nullptr) {}
-    VMCode(VMCode *source) : deque<Command>(), source_(source) {}
-    VMCode(VMCode &rhs) : deque<Command>(rhs), source_(rhs.source_),
-      jump_record_(rhs.jump_record_) {}
-    VMCode(VMCode &&rhs) : VMCode(rhs) {}
-
-    void AddJumpRecord(size_t index, list<size_t> record) {
-      jump_record_.emplace(make_pair(index, record));
+    VMCode() : deque<Command>() {}
+    VMCode(VMCode &rhs) : deque<Command>(rhs),
+      instructions_(rhs.instructions_),
+      operands_(rhs.operands_), identifiers_(rhs.identifiers_),
+      constants_(rhs.constants_), free_variables_(rhs.free_variables_) {}
+    VMCode(VMCode &&rhs) noexcept : deque<Command>(std::move(rhs)),
+      instructions_(std::move(rhs.instructions_)),
+      operands_(std::move(rhs.operands_)),
+      identifiers_(std::move(rhs.identifiers_)),
+      constants_(std::move(rhs.constants_)),
+      free_variables_(std::move(rhs.free_variables_)) {}
+
+    void Lowering();
+
+    Instruction &GetInstruction(size_t idx) { return instructions_[idx]; }
+
+    size_t GetInstructionCount() const { return instructions_.size(); }
+
+    ArgumentView GetArguments(Instruction &inst) {
+      return ArgumentView(operands_.data() + inst.arg_head, inst.arg_size);
+    }
+
+    Argument &GetDomain(Instruction &inst) { return operands_[inst.domain]; }
+
+    const string &GetIdentifier(Instruction &inst) { return identifiers_[inst.id]; }
+
+    //Literals are parsed once in lowering pass. Returned object shares
+    //content with constant pool, binding replaces it instead of writing.
+    Object GetConstant(Argument &arg) { return constants_[arg.GetConstantIndex()]; }
+
+    void SetFreeVariables(size_t idx, vector<string> &&ids) {
+      free_variables_[idx] = std::move(ids);
     }
 
-    bool FindJumpRecord(size_t index, stack<size_t> &dest);
+    const vector<string> &GetFreeVariables(size_t idx) {
+      static const vector<string> empty;
+      auto it = free_variables_.find(idx);
+      return it != free_variables_.end() ? it->second : empty;
+    }
   };
 
   using VMCodePointer = VMCode * ;